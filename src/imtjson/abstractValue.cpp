@@ -5,7 +5,7 @@ namespace json {
 	class UndefinedValue : public AbstractValue {
 	public:
 		UndefinedValue() {
-			addRef();
+			setImmortal();
 		}
 	};
 
@@ -2,22 +2,25 @@
 
 #include <vector>
 #include "basicValues.h"
+#include "serializedCache.h"
 
 namespace json {
 
 	class Array;
 
-	class ArrayValue : public AbstractArrayValue {
+	class ArrayValue : public AbstractArrayValue, public SerializedCache {
 	public:
 
 		ArrayValue(std::vector<PValue> &&value);
 		
+		virtual ValueTypeFlags flags() const override {return serializedCacheFlags();}
 		virtual std::size_t size() const override;
 		virtual const IValue *itemAtIndex(std::size_t index) const override;
 		virtual bool enumItems(const IEnumFn &) const override;
 
 		StringView<PValue> getItems() const {return v;}
 		virtual bool getBool() const override {return true;}
+		virtual const SerializedCache *getSerializedCache() const override {return this;}
 
 	protected:
 		std::vector<PValue> v;
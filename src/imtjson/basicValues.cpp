@@ -1,3 +1,4 @@
+#include <type_traits>
 #include "basicValues.h"
 
 #include "value.h"
@@ -6,10 +7,35 @@ namespace json {
 template<typename T>
 class AllocOnFirstAccess: public RefCntPtr<IValue> {
 public:
-	AllocOnFirstAccess():RefCntPtr<IValue>(new T) {}
+	AllocOnFirstAccess():RefCntPtr<IValue>(new T) {ptr->setImmortal();}
 
 };
 
+///Table of preallocated immortal values
+/** Values are constructed in the static storage, they are never destroyed */
+template<typename T, std::size_t count>
+class ImmortalTable {
+public:
+	template<typename Fn>
+	explicit ImmortalTable(const Fn &create) {
+		for (std::size_t i = 0; i < count; i++) {
+			const T *v = create(&items[i], i);
+			v->setImmortal();
+		}
+	}
+
+	const IValue *operator[](std::size_t idx) const {
+		return reinterpret_cast<const T *>(&items[idx]);
+	}
+
+protected:
+	typename std::aligned_storage<sizeof(T), alignof(T)>::type items[count];
+};
+
+	///Range of preallocated integer numbers
+	static const std::intptr_t smallIntMin = -128;
+	static const std::intptr_t smallIntMax = 1023;
+
 
 	template<bool v>
 	class StaticBool : public BoolValue {
@@ -30,6 +56,15 @@ public:
 		virtual StringView<char> getString() const override { return StringView<char>(); }
 	};
 
+	class StaticCharValue : public AbstractStringValue {
+	public:
+		StaticCharValue(char c) { str[0] = c; str[1] = 0; }
+		virtual StringView<char> getString() const override { return StringView<char>(str, 1); }
+		virtual bool getBool() const override { return true; }
+	protected:
+		char str[2];
+	};
+
 	class StaticEmptyArrayValue : public AbstractArrayValue {
 	public:
 		virtual std::size_t size() const override { return 0; }
@@ -77,6 +112,27 @@ public:
 	}
 
 
+	const IValue * AbstractNumberValue::getSmallInt(std::intptr_t v)
+	{
+		static ImmortalTable<IntegerValue, smallIntMax - smallIntMin + 1> table(
+			[](void *ptr, std::size_t idx) {
+				return ::new(ptr) IntegerValue(smallIntMin + std::intptr_t(idx));
+			});
+		if (v < smallIntMin || v > smallIntMax) return nullptr;
+		return table[v - smallIntMin];
+	}
+
+	const IValue * AbstractNumberValue::getSmallUInt(std::uintptr_t v)
+	{
+		static ImmortalTable<UnsignedIntegerValue, smallIntMax + 1> table(
+			[](void *ptr, std::size_t idx) {
+				return ::new(ptr) UnsignedIntegerValue(idx);
+			});
+		if (v > std::uintptr_t(smallIntMax)) return nullptr;
+		return table[v];
+	}
+
+
 	const IValue * AbstractStringValue::getEmptyString()
 	{
 		static AllocOnFirstAccess<StaticEmptyStringValue> emptyStr;
@@ -84,6 +140,17 @@ public:
 	}
 
 
+	const IValue * AbstractStringValue::getSmallString(const StringView<char> &str)
+	{
+		static ImmortalTable<StaticCharValue, 128> table(
+			[](void *ptr, std::size_t idx) {
+				return ::new(ptr) StaticCharValue((char)idx);
+			});
+		if (str.length != 1 || (unsigned char)str.data[0] >= 128) return nullptr;
+		return table[(unsigned char)str.data[0]];
+	}
+
+
 	const IValue * AbstractArrayValue::getEmptyArray()
 	{
 		static AllocOnFirstAccess<StaticEmptyArrayValue> emptyArray;
@@ -40,7 +40,16 @@ namespace json {
 		virtual std::uintptr_t getUInt() const override = 0;
 
 		static const IValue *getZero();
-
+		///Returns preallocated value of small signed integer
+		/** Preallocated values are immortal, so creating them doesn't allocate memory
+		 * and doesn't touch any reference counter
+		 * @param v number
+		 * @return the value, or nullptr, if the number is out of range of preallocated values
+		 */
+		static const IValue *getSmallInt(std::intptr_t v);
+		///Returns preallocated value of small unsigned integer
+		/** @see getSmallInt() */
+		static const IValue *getSmallUInt(std::uintptr_t v);
 
 		virtual bool equal(const IValue *other) const override;
 
@@ -57,6 +66,12 @@ namespace json {
 
 
 		static const IValue *getEmptyString();
+		///Returns preallocated value of single character ASCII string
+		/**
+		 * @param str string
+		 * @return the value, or nullptr, if the string is not single ASCII character
+		 */
+		static const IValue *getSmallString(const StringView<char> &str);
 		virtual bool equal(const IValue *other) const override;
 
 	};
@@ -0,0 +1,400 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include "charScan.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define IMTJSON_SSE2 1
+#include <emmintrin.h>
+#if defined(__GNUC__) || defined(__clang__)
+#define IMTJSON_AVX2 1
+#define IMTJSON_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#define IMTJSON_AVX2 1
+#define IMTJSON_TARGET_AVX2
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+#endif
+
+namespace json {
+
+	typedef const char *(*ScanFn)(const char *begin, const char *end);
+
+	static const char *findStringSpecialScalar(const char *begin, const char *end) {
+		while (begin != end && !isStringSpecial(*begin)) ++begin;
+		return begin;
+	}
+
+	static const char *skipWhitespaceScalar(const char *begin, const char *end) {
+		while (begin != end && isJsonWhitespace(*begin)) ++begin;
+		return begin;
+	}
+
+	static inline int ctz64(std::uint64_t mask) {
+#ifdef _MSC_VER
+		unsigned long idx;
+#ifdef _WIN64
+		_BitScanForward64(&idx, mask);
+#else
+		if (!_BitScanForward(&idx, (unsigned long)mask)) {
+			_BitScanForward(&idx, (unsigned long)(mask >> 32));
+			idx += 32;
+		}
+#endif
+		return (int)idx;
+#else
+		return __builtin_ctzll(mask);
+#endif
+	}
+
+	static inline int popcount64(std::uint64_t mask) {
+		int cnt = 0;
+		while (mask) {
+			mask &= mask - 1;
+			cnt++;
+		}
+		return cnt;
+	}
+
+	///Classified characters of a block of 64 bytes, one bit per character
+	struct BlockMasks {
+		///brackets, braces, colons and commas
+		std::uint64_t op;
+		///whitespaces
+		std::uint64_t ws;
+		///quotes
+		std::uint64_t quote;
+		///backslashes
+		std::uint64_t bslash;
+	};
+
+	///Calculates for each bit xor of all lower bits including the bit
+	static inline std::uint64_t prefixXor(std::uint64_t x) {
+		x ^= x << 1;
+		x ^= x << 2;
+		x ^= x << 4;
+		x ^= x << 8;
+		x ^= x << 16;
+		x ^= x << 32;
+		return x;
+	}
+
+	static inline std::uint64_t structuralsOfBlock(const BlockMasks &m, StructuralState &st) {
+		//character is escaped, when it follows odd count of backslashes. Sequences of
+		//backslashes are found by the carry of the addition
+		const std::uint64_t evenBits = 0x5555555555555555ULL;
+		std::uint64_t bslash = m.bslash & ~st.prevEscaped;
+		std::uint64_t followsEscape = (bslash << 1) | st.prevEscaped;
+		std::uint64_t oddStarts = bslash & ~evenBits & ~followsEscape;
+		std::uint64_t seqOnEven = oddStarts + bslash;
+		st.prevEscaped = seqOnEven < oddStarts ? 1 : 0;
+		std::uint64_t escaped = (evenBits ^ (seqOnEven << 1)) & followsEscape;
+		//unescaped quotes toggle the string
+		std::uint64_t quote = m.quote & ~escaped;
+		std::uint64_t inString = prefixXor(quote) ^ st.prevInString;
+		st.prevInString = (std::uint64_t)((std::int64_t)inString >> 63);
+		//numbers and literals are reported by their first character
+		std::uint64_t scalar = ~(m.op | m.ws);
+		std::uint64_t nonQuoteScalar = scalar & ~quote;
+		std::uint64_t followsScalar = (nonQuoteScalar << 1) | st.prevScalar;
+		st.prevScalar = nonQuoteScalar >> 63;
+		//content of the string and the closing quote are not structural
+		std::uint64_t stringTail = inString ^ quote;
+		return (m.op | (scalar & ~followsScalar)) & ~stringTail;
+	}
+
+	static inline void storeStructurals(std::uint64_t bits, std::size_t base, std::vector<std::uint32_t> &out) {
+		if (bits == 0) return;
+		std::size_t n = out.size();
+		out.resize(n + popcount64(bits));
+		std::uint32_t *o = out.data() + n;
+		while (bits) {
+			*o++ = (std::uint32_t)(base + ctz64(bits));
+			bits &= bits - 1;
+		}
+	}
+
+	template<void (*classify)(const char *, BlockMasks &)>
+	static void findStructuralsT(const char *text, std::size_t length, std::vector<std::uint32_t> &out, StructuralState &st) {
+		BlockMasks m;
+		out.clear();
+		std::size_t pos = 0;
+		for (; length - pos >= 64; pos += 64) {
+			classify(text + pos, m);
+			storeStructurals(structuralsOfBlock(m, st), pos, out);
+		}
+		if (pos < length) {
+			//the last block is padded by spaces
+			char buff[64];
+			std::memset(buff, ' ', sizeof(buff));
+			std::memcpy(buff, text + pos, length - pos);
+			classify(buff, m);
+			storeStructurals(structuralsOfBlock(m, st), pos, out);
+		}
+	}
+
+	static void classifyScalar(const char *p, BlockMasks &m) {
+		m.op = m.ws = m.quote = m.bslash = 0;
+		for (int i = 0; i < 64; i++) {
+			std::uint64_t bit = std::uint64_t(1) << i;
+			switch (p[i]) {
+			case '{': case '}': case '[': case ']': case ':': case ',': m.op |= bit; break;
+			case '"': m.quote |= bit; break;
+			case '\\': m.bslash |= bit; break;
+			default: if (isJsonWhitespace(p[i])) m.ws |= bit; break;
+			}
+		}
+	}
+
+	static void findStructuralsScalar(const char *text, std::size_t length, std::vector<std::uint32_t> &out, StructuralState &st) {
+		findStructuralsT<classifyScalar>(text, length, out, st);
+	}
+
+#ifdef IMTJSON_SSE2
+
+	static inline int ctz(unsigned int mask) {
+#ifdef _MSC_VER
+		unsigned long idx;
+		_BitScanForward(&idx, mask);
+		return (int)idx;
+#else
+		return __builtin_ctz(mask);
+#endif
+	}
+
+	static const char *findStringSpecialSSE2(const char *begin, const char *end) {
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i bslash = _mm_set1_epi8('\\');
+		//signed compare - non-ASCII bytes are negative, so they are also below the space
+		const __m128i space = _mm_set1_epi8(' ');
+		while (end - begin >= 16) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+			__m128i r = _mm_or_si128(
+					_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, bslash)),
+					_mm_cmplt_epi8(v, space));
+			int mask = _mm_movemask_epi8(r);
+			if (mask) return begin + ctz(mask);
+			begin += 16;
+		}
+		return findStringSpecialScalar(begin, end);
+	}
+
+	static const char *skipWhitespaceSSE2(const char *begin, const char *end) {
+		const __m128i space = _mm_set1_epi8(' ');
+		const __m128i below = _mm_set1_epi8('\t' - 1);
+		const __m128i above = _mm_set1_epi8('\r' + 1);
+		while (end - begin >= 16) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+			__m128i r = _mm_or_si128(_mm_cmpeq_epi8(v, space),
+					_mm_and_si128(_mm_cmpgt_epi8(v, below), _mm_cmplt_epi8(v, above)));
+			int mask = _mm_movemask_epi8(r) ^ 0xFFFF;
+			if (mask) return begin + ctz(mask);
+			begin += 16;
+		}
+		return skipWhitespaceScalar(begin, end);
+	}
+
+	static void classifySSE2(const char *p, BlockMasks &m) {
+		//'[' and '{' (also ']' and '}') differ only in the bit 0x20
+		const __m128i caseBit = _mm_set1_epi8(0x20);
+		const __m128i openBr = _mm_set1_epi8('{');
+		const __m128i closeBr = _mm_set1_epi8('}');
+		const __m128i colon = _mm_set1_epi8(':');
+		const __m128i comma = _mm_set1_epi8(',');
+		const __m128i space = _mm_set1_epi8(' ');
+		const __m128i below = _mm_set1_epi8('\t' - 1);
+		const __m128i above = _mm_set1_epi8('\r' + 1);
+		const __m128i quote = _mm_set1_epi8('"');
+		const __m128i bslash = _mm_set1_epi8('\\');
+		m.op = m.ws = m.quote = m.bslash = 0;
+		for (int i = 0; i < 4; i++) {
+			__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i * 16));
+			__m128i l = _mm_or_si128(v, caseBit);
+			__m128i op = _mm_or_si128(
+					_mm_or_si128(_mm_cmpeq_epi8(l, openBr), _mm_cmpeq_epi8(l, closeBr)),
+					_mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)));
+			__m128i ws = _mm_or_si128(_mm_cmpeq_epi8(v, space),
+					_mm_and_si128(_mm_cmpgt_epi8(v, below), _mm_cmplt_epi8(v, above)));
+			int shift = i * 16;
+			m.op |= (std::uint64_t)(unsigned int)_mm_movemask_epi8(op) << shift;
+			m.ws |= (std::uint64_t)(unsigned int)_mm_movemask_epi8(ws) << shift;
+			m.quote |= (std::uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)) << shift;
+			m.bslash |= (std::uint64_t)(unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, bslash)) << shift;
+		}
+	}
+
+	static void findStructuralsSSE2(const char *text, std::size_t length, std::vector<std::uint32_t> &out, StructuralState &st) {
+		findStructuralsT<classifySSE2>(text, length, out, st);
+	}
+
+#endif
+
+#ifdef IMTJSON_AVX2
+
+	IMTJSON_TARGET_AVX2 static const char *findStringSpecialAVX2(const char *begin, const char *end) {
+		const __m256i quote = _mm256_set1_epi8('"');
+		const __m256i bslash = _mm256_set1_epi8('\\');
+		const __m256i control = _mm256_set1_epi8(' ' - 1);
+		while (end - begin >= 32) {
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+			//AVX2 has no signed "less than" - use control > v
+			__m256i r = _mm256_or_si256(
+					_mm256_or_si256(_mm256_cmpeq_epi8(v, quote), _mm256_cmpeq_epi8(v, bslash)),
+					_mm256_cmpgt_epi8(control, v));
+			unsigned int mask = (unsigned int)_mm256_movemask_epi8(r);
+			if (mask) return begin + ctz(mask);
+			begin += 32;
+		}
+		return findStringSpecialSSE2(begin, end);
+	}
+
+	IMTJSON_TARGET_AVX2 static const char *skipWhitespaceAVX2(const char *begin, const char *end) {
+		const __m256i space = _mm256_set1_epi8(' ');
+		const __m256i below = _mm256_set1_epi8('\t' - 1);
+		const __m256i above = _mm256_set1_epi8('\r' + 1);
+		while (end - begin >= 32) {
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+			__m256i r = _mm256_or_si256(_mm256_cmpeq_epi8(v, space),
+					_mm256_and_si256(_mm256_cmpgt_epi8(v, below), _mm256_cmpgt_epi8(above, v)));
+			unsigned int mask = ~(unsigned int)_mm256_movemask_epi8(r);
+			if (mask) return begin + ctz(mask);
+			begin += 32;
+		}
+		return skipWhitespaceSSE2(begin, end);
+	}
+
+	IMTJSON_TARGET_AVX2 static void classifyAVX2(const char *p, BlockMasks &m) {
+		const __m256i caseBit = _mm256_set1_epi8(0x20);
+		const __m256i openBr = _mm256_set1_epi8('{');
+		const __m256i closeBr = _mm256_set1_epi8('}');
+		const __m256i colon = _mm256_set1_epi8(':');
+		const __m256i comma = _mm256_set1_epi8(',');
+		const __m256i space = _mm256_set1_epi8(' ');
+		const __m256i below = _mm256_set1_epi8('\t' - 1);
+		const __m256i above = _mm256_set1_epi8('\r' + 1);
+		const __m256i quote = _mm256_set1_epi8('"');
+		const __m256i bslash = _mm256_set1_epi8('\\');
+		m.op = m.ws = m.quote = m.bslash = 0;
+		for (int i = 0; i < 2; i++) {
+			__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + i * 32));
+			__m256i l = _mm256_or_si256(v, caseBit);
+			__m256i op = _mm256_or_si256(
+					_mm256_or_si256(_mm256_cmpeq_epi8(l, openBr), _mm256_cmpeq_epi8(l, closeBr)),
+					_mm256_or_si256(_mm256_cmpeq_epi8(v, colon), _mm256_cmpeq_epi8(v, comma)));
+			__m256i ws = _mm256_or_si256(_mm256_cmpeq_epi8(v, space),
+					_mm256_and_si256(_mm256_cmpgt_epi8(v, below), _mm256_cmpgt_epi8(above, v)));
+			int shift = i * 32;
+			m.op |= (std::uint64_t)(unsigned int)_mm256_movemask_epi8(op) << shift;
+			m.ws |= (std::uint64_t)(unsigned int)_mm256_movemask_epi8(ws) << shift;
+			m.quote |= (std::uint64_t)(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)) << shift;
+			m.bslash |= (std::uint64_t)(unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, bslash)) << shift;
+		}
+	}
+
+	static void findStructuralsAVX2(const char *text, std::size_t length, std::vector<std::uint32_t> &out, StructuralState &st) {
+		findStructuralsT<classifyAVX2>(text, length, out, st);
+	}
+
+	static bool hasAVX2() {
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if (info[0] < 7) return false;
+		__cpuid(info, 1);
+		//OSXSAVE and AVX, and the OS saves YMM registers
+		if ((info[2] & 0x18000000) != 0x18000000) return false;
+		if ((_xgetbv(0) & 6) != 6) return false;
+		__cpuidex(info, 7, 0);
+		return (info[1] & 0x20) != 0;
+#else
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2") != 0;
+#endif
+	}
+
+#endif
+
+	static const char *findStringSpecialInit(const char *begin, const char *end);
+	static const char *skipWhitespaceInit(const char *begin, const char *end);
+	static void findStructuralsInit(const char *text, std::size_t length, std::vector<std::uint32_t> &out, StructuralState &st);
+
+	typedef void (*StructuralsFn)(const char *text, std::size_t length, std::vector<std::uint32_t> &out, StructuralState &st);
+
+	///Selected implementations - the first call selects the best one for the current CPU
+	static std::atomic<ScanFn> findStringSpecialImpl(&findStringSpecialInit);
+	static std::atomic<ScanFn> skipWhitespaceImpl(&skipWhitespaceInit);
+	static std::atomic<StructuralsFn> findStructuralsImpl(&findStructuralsInit);
+
+	static void selectImpl() {
+#if defined(IMTJSON_AVX2)
+		if (hasAVX2()) {
+			findStringSpecialImpl.store(&findStringSpecialAVX2, std::memory_order_relaxed);
+			skipWhitespaceImpl.store(&skipWhitespaceAVX2, std::memory_order_relaxed);
+			findStructuralsImpl.store(&findStructuralsAVX2, std::memory_order_relaxed);
+			return;
+		}
+#endif
+#if defined(IMTJSON_SSE2)
+		findStringSpecialImpl.store(&findStringSpecialSSE2, std::memory_order_relaxed);
+		skipWhitespaceImpl.store(&skipWhitespaceSSE2, std::memory_order_relaxed);
+		findStructuralsImpl.store(&findStructuralsSSE2, std::memory_order_relaxed);
+#else
+		findStringSpecialImpl.store(&findStringSpecialScalar, std::memory_order_relaxed);
+		skipWhitespaceImpl.store(&skipWhitespaceScalar, std::memory_order_relaxed);
+		findStructuralsImpl.store(&findStructuralsScalar, std::memory_order_relaxed);
+#endif
+	}
+
+	static const char *findStringSpecialInit(const char *begin, const char *end) {
+		selectImpl();
+		return findStringSpecialImpl.load(std::memory_order_relaxed)(begin, end);
+	}
+
+	static const char *skipWhitespaceInit(const char *begin, const char *end) {
+		selectImpl();
+		return skipWhitespaceImpl.load(std::memory_order_relaxed)(begin, end);
+	}
+
+	static void findStructuralsInit(const char *text, std::size_t length, std::vector<std::uint32_t> &out, StructuralState &st) {
+		selectImpl();
+		findStructuralsImpl.load(std::memory_order_relaxed)(text, length, out, st);
+	}
+
+	const char *findStringSpecial(const char *begin, const char *end) {
+		return findStringSpecialImpl.load(std::memory_order_relaxed)(begin, end);
+	}
+
+	const char *skipWhitespace(const char *begin, const char *end) {
+		return skipWhitespaceImpl.load(std::memory_order_relaxed)(begin, end);
+	}
+
+	void findStructurals(const char *text, std::size_t length, std::vector<std::uint32_t> &out) {
+		StructuralState st = {0, 0, 0};
+		findStructuralsImpl.load(std::memory_order_relaxed)(text, length, out, st);
+	}
+
+	StructuralScanner::StructuralScanner(const char *text, std::size_t length, std::size_t windowSize)
+		:text(text),length(length),pos(0),base(0)
+	{
+		//windows are aligned to the blocks, only the last one is padded
+		const std::size_t maxWindowSize = 0x80000000u;
+		if (windowSize > maxWindowSize) windowSize = maxWindowSize;
+		this->windowSize = windowSize < 64 ? 64 : windowSize - windowSize % 64;
+		state.prevEscaped = state.prevInString = state.prevScalar = 0;
+	}
+
+	bool StructuralScanner::next(std::vector<std::uint32_t> &out) {
+		if (pos >= length) {
+			out.clear();
+			return false;
+		}
+		std::size_t sz = std::min(windowSize, length - pos);
+		findStructuralsImpl.load(std::memory_order_relaxed)(text + pos, sz, out, state);
+		base = pos;
+		pos += sz;
+		return true;
+	}
+
+}
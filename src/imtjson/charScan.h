@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace json {
+
+	///Finds first character which needs special processing inside of JSON string
+	/** Searches for quotes, backslash, control characters (below 32) and any non-ASCII byte.
+	The function scans 16 or 32 bytes at once when the CPU supports SSE2 or AVX2 (detected at
+	runtime). Other platforms use simple loop.
+
+	@param begin first character
+	@param end end of the text
+	@return pointer to the found character, or end, if there is no such character
+	*/
+	const char *findStringSpecial(const char *begin, const char *end);
+
+	///Skips JSON whitespaces
+	/** Whitespaces are the characters accepted by the function isspace() in the "C" locale
+	(space, \\t, \\n, \\v, \\f and \\r)
+
+	@param begin first character
+	@param end end of the text
+	@return pointer to the first non-whitespace character, or end
+	*/
+	const char *skipWhitespace(const char *begin, const char *end);
+
+	///Finds positions of structural characters in JSON text
+	/** Structural characters are brackets, braces, colons and commas outside of strings,
+	opening quotes of strings and the first characters of other values (numbers and literals).
+	The text is classified in blocks of 64 bytes by SSE2 or AVX2 (when available), strings
+	and escape sequences are resolved by bit operations without branches.
+
+	Characters inside of strings are never reported. If the text ends inside of a string,
+	the rest of the text is considered as the string.
+
+	@param text JSON text
+	@param length length of the text. It must be less than 4GB
+	@param out receives offsets of the structural characters in ascending order. The
+	vector is cleared first
+	*/
+	void findStructurals(const char *text, std::size_t length, std::vector<std::uint32_t> &out);
+
+	///State of the structural scanner carried from block to block
+	struct StructuralState {
+		///first character of the block is escaped (1) or not (0)
+		std::uint64_t prevEscaped;
+		///the block starts inside of string (all ones) or not (zero)
+		std::uint64_t prevInString;
+		///the last character of previous block was part of a number or literal (1) or not (0)
+		std::uint64_t prevScalar;
+	};
+
+	///Finds positions of structural characters in JSON text of any length
+	/** The text is scanned in windows, which are shorter than 4GB, so the offsets fit into
+	32 bits. The state of the strings is carried from window to window, so the result is
+	the same as the result of findStructurals() for the whole text. Only the index of the
+	current window is kept in the memory.
+
+	@code
+	StructuralScanner scanner(text, length);
+	std::vector<std::uint32_t> st;
+	while (scanner.next(st)) {
+		for (std::uint32_t pos : st) process(scanner.getBase() + pos);
+	}
+	@endcode
+	*/
+	class StructuralScanner {
+	public:
+		///Default size of the window
+		static const std::size_t defaultWindowSize = 64 * 1024 * 1024;
+
+		///Prepares the scanning
+		/**
+		@param text JSON text
+		@param length length of the text
+		@param windowSize size of the window. It is rounded down to a multiple of 64 and
+		limited to 2GB
+		*/
+		StructuralScanner(const char *text, std::size_t length, std::size_t windowSize = defaultWindowSize);
+
+		///Scans the next window
+		/**
+		@param out receives offsets of the structural characters relative to the beginning
+		of the window (see getBase()). The vector is cleared first
+		@retval true next window has been scanned
+		@retval false end of the text
+		*/
+		bool next(std::vector<std::uint32_t> &out);
+		///Retrieves offset of the window scanned by the last call of next()
+		std::size_t getBase() const { return base; }
+
+	protected:
+		const char *text;
+		std::size_t length;
+		std::size_t windowSize;
+		///offset of the next window
+		std::size_t pos;
+		std::size_t base;
+		StructuralState state;
+	};
+
+	///Tests whether character needs special processing inside of JSON string
+	inline bool isStringSpecial(char c) {
+		unsigned char u = (unsigned char)c;
+		return u < 32 || u >= 0x80 || c == '"' || c == '\\';
+	}
+
+	///Tests whether character is JSON whitespace (same set as skipWhitespace())
+	inline bool isJsonWhitespace(char c) {
+		return c == ' ' || (c >= '\t' && c <= '\r');
+	}
+
+}
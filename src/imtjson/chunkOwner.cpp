@@ -0,0 +1,96 @@
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+#include "chunkOwner.h"
+
+namespace json {
+
+	///Chunks are aligned to its size, so the address of the chunk can be calculated from any pointer
+	static const unsigned int chunkBits = 16;
+	static_assert((std::size_t(1) << chunkBits) == ChunkOwner::chunkSize, "chunkBits doesn't match chunkSize");
+
+
+	///Maps the chunks to their owners
+	/** Two level table indexed by the address of the chunk. It covers 48 bits of address space.
+	 Leaves are allocated on the first use and never released. Lookups are lock-free */
+	class ChunkMap {
+	public:
+		static const unsigned int leafBits = 16;
+		static const std::size_t leafSize = std::size_t(1) << leafBits;
+		static const std::size_t topSize = std::size_t(1) << (48 - chunkBits - leafBits);
+
+		typedef std::atomic<ChunkOwner *> Leaf;
+
+		ChunkOwner *find(const void *ptr) const {
+			std::uintptr_t idx = reinterpret_cast<std::uintptr_t>(ptr) >> chunkBits;
+			std::uintptr_t t = idx >> leafBits;
+			if (t >= topSize) return nullptr;
+			Leaf *l = top[t].load(std::memory_order_acquire);
+			if (l == nullptr) return nullptr;
+			return l[idx & (leafSize - 1)].load(std::memory_order_acquire);
+		}
+
+		bool set(const void *chunk, ChunkOwner *owner) {
+			std::uintptr_t idx = reinterpret_cast<std::uintptr_t>(chunk) >> chunkBits;
+			std::uintptr_t t = idx >> leafBits;
+			if (t >= topSize) return false;
+			Leaf *l = top[t].load(std::memory_order_acquire);
+			if (l == nullptr) {
+				//zeroed memory is the same as array of nullptr-s
+				Leaf *nl = reinterpret_cast<Leaf *>(std::calloc(leafSize, sizeof(Leaf)));
+				if (nl == nullptr) return false;
+				if (top[t].compare_exchange_strong(l, nl, std::memory_order_acq_rel)) l = nl;
+				else std::free(nl);
+			}
+			l[idx & (leafSize - 1)].store(owner, std::memory_order_release);
+			return true;
+		}
+
+		void clear(const void *chunk) {
+			set(chunk, nullptr);
+		}
+
+	protected:
+		///zero initialized as static variable
+		std::atomic<Leaf *> top[topSize];
+	};
+
+	static ChunkMap chunkMap;
+
+	bool ChunkOwner::deallocOwned(void *ptr) {
+		ChunkOwner *owner = chunkMap.find(ptr);
+		if (owner == nullptr) return false;
+		owner->deallocBlock(ptr);
+		return true;
+	}
+
+	char *ChunkOwner::allocChunk() {
+		char *c;
+#ifdef _WIN32
+		c = reinterpret_cast<char *>(_aligned_malloc(chunkSize, chunkSize));
+		if (c == nullptr) return nullptr;
+#else
+		void *p;
+		if (posix_memalign(&p, chunkSize, chunkSize)) return nullptr;
+		c = reinterpret_cast<char *>(p);
+#endif
+		if (!chunkMap.set(c, this)) {
+			freeChunk(c);
+			return nullptr;
+		}
+		return c;
+	}
+
+	void ChunkOwner::freeChunk(char *chunk) {
+		chunkMap.clear(chunk);
+#ifdef _WIN32
+		_aligned_free(chunk);
+#else
+		std::free(chunk);
+#endif
+	}
+
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+
+namespace json {
+
+	///Owner of chunks of memory from which the values are allocated
+	/** Chunks are aligned to their size and registered in a global table, so any pointer
+	 * can be mapped back to the owner of its chunk without a header in front of each block.
+	 * This allows to deallocate blocks of an arena or a pool regardless of which allocator
+	 * is currently installed. The default allocator and the pool allocator both
+	 * call deallocOwned() before they release the block by other way.
+	 */
+	class ChunkOwner {
+	public:
+		virtual ~ChunkOwner() {}
+
+		///Size of the chunk (the chunk is also aligned to this size)
+		static const std::size_t chunkSize = 65536;
+
+		///Deallocates the block if it belongs to a registered chunk
+		/**
+		 * @param ptr pointer to the block
+		 * @retval true block belongs to a chunk and it has been deallocated
+		 * @retval false block doesn't belong to any chunk
+		 */
+		static bool deallocOwned(void *ptr);
+
+	protected:
+		///Deallocates the block which belongs to a chunk of this owner
+		virtual void deallocBlock(void *ptr) = 0;
+
+		///Allocates a new chunk and registers it for this owner
+		/** @return pointer to the chunk, or nullptr if it cannot be allocated */
+		char *allocChunk();
+		///Unregisters the chunk and releases its memory
+		void freeChunk(char *chunk);
+	};
+
+}
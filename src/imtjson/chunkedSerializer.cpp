@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <cstring>
+#include "chunkedSerializer.h"
+#include "objectValue.h"
+
+namespace json {
+
+	namespace {
+
+		///Appends the output of the serializer to the string
+		struct StringTarget {
+			std::string *out;
+			void operator()(char c) const { out->push_back(c); }
+		};
+
+	}
+
+	template<>
+	struct SerializerBlockWriter<StringTarget> {
+		static void write(StringTarget &target, const char *text, std::size_t len) {
+			target.out->append(text, len);
+		}
+	};
+
+	namespace {
+
+		///Serializer of the scalar values, keys and cached containers
+		class PartSerializer : public Serializer<StringTarget> {
+		public:
+			PartSerializer(std::string &out, bool utf8output, std::size_t baseDepth = 0)
+				:Serializer<StringTarget>(StringTarget{&out}, utf8output, baseDepth) {}
+			using Serializer<StringTarget>::writeString;
+			using Serializer<StringTarget>::writeCached;
+		};
+
+	}
+
+	ChunkedSerializer::ChunkedSerializer(const Value &v, UnicodeFormat format)
+		:root(v),utf8output(format == emitUtf8),started(false),textPos(0)
+	{
+	}
+
+	std::size_t ChunkedSerializer::read(char *buffer, std::size_t size) {
+		std::size_t written = 0;
+		while (written < size) {
+			if (textPos == text.length()) {
+				text.clear();
+				textPos = 0;
+				if (!formatNext()) break;
+			}
+			std::size_t len = std::min(size - written, text.length() - textPos);
+			std::memcpy(buffer + written, text.data() + textPos, len);
+			written += len;
+			textPos += len;
+		}
+		return written;
+	}
+
+	bool ChunkedSerializer::done() const {
+		return started && levels.empty() && textPos == text.length();
+	}
+
+	bool ChunkedSerializer::formatNext() {
+		if (!started) {
+			started = true;
+			formatValue(root.getHandle());
+			return true;
+		}
+		if (levels.empty()) return false;
+		Level &l = levels.back();
+		if (l.index == l.count) {
+			text.push_back(l.container->type() == object ? '}' : ']');
+			levels.pop_back();
+			return true;
+		}
+		std::size_t i = l.index++;
+		if (i) text.push_back(',');
+		const IValue *item;
+		if (l.compact) {
+			const CompactObjectValue *cobj = static_cast<const CompactObjectValue *>(l.container->unproxy());
+			PartSerializer(text, utf8output).writeString(cobj->keyAt(i));
+			text.push_back(':');
+			item = cobj->valueAt(i);
+		} else {
+			item = l.container->itemAtIndex(i);
+			if (l.container->type() == object) {
+				PartSerializer(text, utf8output).writeString(item->getMemberName());
+				text.push_back(':');
+			}
+		}
+		//the reference l is not valid after this call
+		formatValue(item);
+		return true;
+	}
+
+	void ChunkedSerializer::formatValue(const IValue *v) {
+		PartSerializer ser(text, utf8output, levels.size());
+		ValueType t = v->type();
+		//raw JSON is written as it is, it is a scalar for the serializer
+		if ((t != object && t != array) || ((v->flags() & userDefined) && v->unproxy()->getRawJson())) {
+			ser.serialize(v);
+			return;
+		}
+		if (ser.writeCached(v)) return;
+		if (levels.size() >= maxNestingDepth)
+			throw SerializerError("Too deep nesting");
+		const CompactObjectValue *cobj = v->unproxy()->asCompactObject();
+		levels.push_back(Level{v, cobj != nullptr, 0, v->size()});
+		text.push_back(t == object ? '{' : '[');
+	}
+
+}
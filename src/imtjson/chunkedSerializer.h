@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "serializer.h"
+
+namespace json {
+
+	///Serializer which produces the output in parts on request
+	/** The Serializer writes the whole value to the target at once. The ChunkedSerializer
+	is pulled by the caller instead: each call of the function read() fills the given buffer
+	with the next part of the output and returns. The position in the value is stored in
+	an explicit stack of open containers, so a non-blocking writer can request the next
+	part when the socket is ready, and only the current part is kept in the memory.
+
+	The output is the same as the output of Value::serialize(). Each scalar value is formatted
+	at once, so the internal buffer grows to the size of the longest string (or to the size of
+	a cached or raw JSON container).
+
+	@code
+	ChunkedSerializer ser(doc);
+	char buffer[4096];
+	std::size_t len;
+	while ((len = ser.read(buffer, sizeof(buffer))) != 0) {
+		send(socket, buffer, len);
+	}
+	@endcode
+
+	@note The serialized value must not be modified until the serialization is complete
+	*/
+	class ChunkedSerializer {
+	public:
+		///Prepares the serialization
+		/**
+		@param v value to serialize
+		@param format unicode format
+		*/
+		ChunkedSerializer(const Value &v, UnicodeFormat format = defaultUnicodeFormat);
+
+		///Writes next part of the output
+		/**
+		@param buffer buffer which receives the output
+		@param size size of the buffer
+		@return count of bytes written to the buffer. Returns less than size only at the end of
+		the output, returns zero when there is no more output
+		@exception SerializerError the value contains an invalid string
+		*/
+		std::size_t read(char *buffer, std::size_t size);
+
+		///Returns true, when whole output has been read
+		bool done() const;
+
+	protected:
+		///Open container
+		struct Level {
+			PValue container;
+			///true if the container is the CompactObjectValue (keys are read directly)
+			bool compact;
+			///index of the next item
+			std::size_t index;
+			std::size_t count;
+		};
+
+		Value root;
+		bool utf8output;
+		bool started;
+		///stack of open containers
+		std::vector<Level> levels;
+		///formatted text which was not read yet
+		std::string text;
+		///position of the unread part of the text
+		std::size_t textPos;
+
+		///Formats next part of the value to the text
+		/** @retval false end of the output */
+		bool formatNext();
+		///Formats the value, containers are opened
+		void formatValue(const IValue *v);
+	};
+
+}
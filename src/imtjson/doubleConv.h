@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+
+namespace json {
+
+	///Size of the buffer required by formatDouble()
+	static const std::size_t formatDoubleBufferSize = 32;
+
+	///Precision, which keeps the shortest representation of the number (see formatDouble())
+	static const std::size_t roundTripPrecision = 17;
+
+	///Formats finite double number
+	/** The function finds the shortest sequence of decimal digits, which parses back to the
+	same number (Grisu2 algorithm). Numbers in range 0.01 ... 1e8 are written without exponent,
+	other numbers are written in the format d.ddde+xx
+
+	@param value finite number to format
+	@param precision maximum count of digits after the decimal point. If the value is
+	lower than roundTripPrecision, the number is rounded
+	@param buffer buffer which has at least formatDoubleBufferSize characters
+	@return pointer to the end of the text
+	*/
+	char *formatDouble(double value, std::size_t precision, char *buffer);
+
+	///Converts decimal number to double
+	/** Result is correctly rounded, so the text written by formatDouble() is converted
+	back to the same number. Short numbers are converted directly, other numbers
+	are converted by the strtod() function (independently on the current locale)
+
+	@param text number in the format digits[.digits][e[-]digits] (without the sign)
+	@param len length of the text
+	@return converted number. It can be infinity, if the number is too large
+	*/
+	double decimalToDouble(const char *text, std::size_t len);
+
+}
@@ -0,0 +1,60 @@
+#include <cstring>
+#include "intConv.h"
+
+namespace json {
+
+	static const char digitPairs[] =
+		"00010203040506070809"
+		"10111213141516171819"
+		"20212223242526272829"
+		"30313233343536373839"
+		"40414243444546474849"
+		"50515253545556575859"
+		"60616263646566676869"
+		"70717273747576777879"
+		"80818283848586878889"
+		"90919293949596979899";
+
+	///Counts decimal digits of the number
+	static inline int countDigits(std::uint64_t value) {
+		int n = 1;
+		for (;;) {
+			if (value < 10) return n;
+			if (value < 100) return n + 1;
+			if (value < 1000) return n + 2;
+			if (value < 10000) return n + 3;
+			value /= 10000;
+			n += 4;
+		}
+	}
+
+	char *formatUnsigned(std::uint64_t value, char *buffer) {
+		char *end = buffer + countDigits(value);
+		char *p = end;
+		//write two digits at once from the end
+		while (value >= 100) {
+			unsigned int i = (unsigned int)(value % 100) * 2;
+			value /= 100;
+			p -= 2;
+			std::memcpy(p, digitPairs + i, 2);
+		}
+		if (value >= 10) {
+			p -= 2;
+			std::memcpy(p, digitPairs + value * 2, 2);
+		}
+		else {
+			*--p = (char)('0' + value);
+		}
+		return end;
+	}
+
+	char *formatSigned(std::int64_t value, char *buffer) {
+		if (value < 0) {
+			*buffer++ = '-';
+			//negate in unsigned arithmetic, -value overflows for the minimum value
+			return formatUnsigned(0 - std::uint64_t(value), buffer);
+		}
+		return formatUnsigned(std::uint64_t(value), buffer);
+	}
+
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace json {
+
+	///Size of the buffer required by formatUnsigned() and formatSigned()
+	static const std::size_t formatIntBufferSize = 24;
+
+	///Formats unsigned integer as decimal number
+	/** Digits are written in pairs using a lookup table, there is no recursion
+	and no division by variable.
+
+	@param value value to format
+	@param buffer buffer which has at least formatIntBufferSize characters. The text
+	starts at the beginning of the buffer
+	@return pointer to the end of the text
+	*/
+	char *formatUnsigned(std::uint64_t value, char *buffer);
+
+	///Formats signed integer as decimal number
+	/** Works for whole range of the type including the minimum value
+	@param value value to format
+	@param buffer buffer which has at least formatIntBufferSize characters. The text
+	starts at the beginning of the buffer
+	@return pointer to the end of the text
+	*/
+	char *formatSigned(std::int64_t value, char *buffer);
+
+}
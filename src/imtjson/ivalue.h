@@ -35,6 +35,21 @@ namespace json {
 	};
 
 
+	///Engines of the parser of contiguous texts (see Value::fromString())
+	enum ParserEngine {
+		///Parser reads the text character by character
+		/** This engine is default */
+		parserStreaming,
+		///Parser finds all structural characters first, then it creates the values (see TapeParser)
+		parserTape
+	};
+
+	///Maximal nesting depth of containers
+	/** Parsers throw ParseError and serializers throw SerializerError, when the containers
+	are nested deeper. Containers are tracked by explicit stacks, so the limit doesn't
+	depend on the size of the native stack. Default is 1024 */
+	extern std::size_t maxNestingDepth;
+
 	///Available binary encoders
 	enum BinaryEncoding {
 		///base64 encoding
@@ -80,9 +95,25 @@ namespace json {
 	 */
 	const ValueTypeFlags objectDiff = 16;
 
+	/// States that the container keeps its serialized form
+	/** The serializer copies the stored text instead of walking through the container.
+	 * @see SerializedCache, Value::enableSerializedCache()
+	 */
+	const ValueTypeFlags serializedCache = 32;
+
+	/// States that the string is not terminated by zero character
+	/** The string refers a part of an other text (see Value::fromSharedString()). The
+	 * class String copies such string, so String::c_str() is always terminated
+	 */
+	const ValueTypeFlags unterminatedString = 64;
+
 	class IValue;
 	typedef RefCntPtr<const IValue> PValue;
 
+	class CompactObjectValue;
+	class RawJsonValue;
+	class SerializedCache;
+
 	class IEnumFn;
 
 	///Interface access internal value of JSON Value
@@ -110,6 +141,14 @@ namespace json {
 
 		virtual bool equal(const IValue *other) const = 0;
 
+		///Returns the value as CompactObjectValue, or nullptr if it is an other type
+		/** The serializer uses these functions on the unproxied value instead of dynamic_cast */
+		virtual const CompactObjectValue *asCompactObject() const { return nullptr; }
+		///Returns the value as RawJsonValue, or nullptr if it is an other type
+		virtual const RawJsonValue *getRawJson() const { return nullptr; }
+		///Returns the cache of the serialized form, or nullptr if the value has no cache
+		virtual const SerializedCache *getSerializedCache() const { return nullptr; }
+
 		void *operator new(std::size_t);
 		void operator delete(void *, std::size_t);
 
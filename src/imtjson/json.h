@@ -2,7 +2,15 @@
 #include "object.h"
 #include "array.h"
 #include "serializer.h"
+#include "chunkedSerializer.h"
 #include "parser.h"
+#include "parseResult.h"
+#include "parallelParser.h"
+#include "jsonStream.h"
+#include "pushParser.h"
+#include "saxParser.h"
 #include "path.h"
 #include "string.h"
 #include "operations.h"
+#include "parseArena.h"
+#include "poolAllocator.h"
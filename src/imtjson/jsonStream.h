@@ -0,0 +1,210 @@
+#pragma once
+
+#include <istream>
+#include "parser.h"
+#include "serializer.h"
+#include "streamBlocks.h"
+
+namespace json {
+
+	///Reads a stream of JSON documents
+	/** The stream can contain newline delimited JSON (NDJSON) or concatenated JSON documents
+	separated by optional whitespaces. Documents are parsed one by one as they are requested,
+	so the memory doesn't depend on the length of the stream. The same parser is used for
+	all documents, so its temporary buffers are allocated only once.
+
+	@tparam Fn source function, which returns next character on each call. At the end of the
+	stream, it must return -1 (see Value::parse()). The IStreamSource is read in blocks
+	(see JsonStreamReader<IStreamSource>)
+
+	@code
+	JsonStreamReader<IStreamSource> reader(IStreamSource(std::cin));
+	Value doc;
+	while (reader.read(doc)) {
+		...
+	}
+	@endcode
+	*/
+	template<typename Fn>
+	class JsonStreamReader {
+	public:
+		JsonStreamReader(const Fn &source) :parser(source) {}
+
+		///Reads next document
+		/**
+		@param out variable which receives the document
+		@retval true document has been read
+		@retval false end of the stream, no more documents
+		@exception ParseError parsing error. The stream can't be read after the error
+		*/
+		bool read(Value &out) {
+			if (parser.atEnd()) return false;
+			out = parser.parse();
+			return true;
+		}
+
+		///Reads next document
+		/**
+		@return the document or undefined value at the end of the stream
+		@exception ParseError parsing error
+		*/
+		Value next() {
+			Value out;
+			read(out);
+			return out;
+		}
+
+		///Retrieves the parser's reader (for example to find position after the last document)
+		const typename Parser<Fn>::Reader &getReader() const { return parser.getReader(); }
+
+	protected:
+		class StreamParser : public Parser<Fn> {
+		public:
+			StreamParser(const Fn &source) :Parser<Fn>(source) {}
+			bool atEnd() { return this->rd.nextWs() == (char)-1; }
+		};
+
+		StreamParser parser;
+	};
+
+	///Source of characters which reads std::istream
+	class IStreamSource {
+	public:
+		IStreamSource(std::istream &input) :input(&input) {}
+		char operator()() const { return (char)input->get(); }
+		std::istream &getStream() const { return *input; }
+
+	protected:
+		std::istream *input;
+	};
+
+	///Reads a stream of JSON documents from std::istream
+	/** The documents are parsed directly in the buffer of the stream (see StreamBlocks), the
+	characters are not extracted one by one. After each document, the characters which were
+	not used by the parser stay in the stream, so the stream is positioned right after the
+	document (or after the whitespaces at the end of the stream)
+	*/
+	template<>
+	class JsonStreamReader<IStreamSource> {
+	protected:
+		///Passes the blocks of the stream to the parser
+		struct BlockFn {
+			StreamBlocks *blocks;
+			StringView<char> operator()(std::size_t used) const { return (*blocks)(used); }
+		};
+
+	public:
+		JsonStreamReader(const IStreamSource &source)
+			:blocks(source.getStream()), parser(BlockSource<BlockFn>(BlockFn{&blocks})) {}
+
+		///Reads next document
+		/**
+		@param out variable which receives the document
+		@retval true document has been read
+		@retval false end of the stream, no more documents
+		@exception ParseError parsing error. The stream can't be read after the error
+		*/
+		bool read(Value &out) {
+			try {
+				bool res = !parser.atEnd();
+				if (res) out = parser.parse();
+				release();
+				return res;
+			}
+			catch (...) {
+				release();
+				throw;
+			}
+		}
+
+		///Reads next document
+		/**
+		@return the document or undefined value at the end of the stream
+		@exception ParseError parsing error
+		*/
+		Value next() {
+			Value out;
+			read(out);
+			return out;
+		}
+
+		///Retrieves the parser's reader (consumed() is count of characters used by all documents)
+		const ParserReader<BlockSource<BlockFn> > &getReader() const { return parser.getReader(); }
+
+	protected:
+		class StreamParser : public Parser<BlockSource<BlockFn> > {
+		public:
+			StreamParser(const BlockSource<BlockFn> &source) :Parser<BlockSource<BlockFn> >(source) {}
+			bool atEnd() { return this->rd.nextWs() == (char)-1; }
+			std::size_t releaseBlock() { return this->rd.releaseBlock(); }
+		};
+
+		StreamBlocks blocks;
+		StreamParser parser;
+
+		///Advances the stream by the used characters
+		void release() {
+			blocks.release(parser.releaseBlock());
+		}
+
+		JsonStreamReader(const JsonStreamReader &) = delete;
+		JsonStreamReader &operator=(const JsonStreamReader &) = delete;
+	};
+
+	///Writes a stream of JSON documents as newline delimited JSON
+	/** Each document is serialized to the buffer and terminated by the new line. The buffer is
+	passed to the sink when it reaches the flushSize, so many small documents are written
+	at once. A large document can be passed in more parts. The buffer is reused for all
+	documents.
+
+	@tparam Sink function which accepts one argument of type StringView<char>
+
+	@code
+	auto sink = [&](const StringView<char> &data) {fwrite(data.data, 1, data.length, f);};
+	JsonStreamWriter<decltype(sink)> writer(sink);
+	writer.write(doc1);
+	writer.write(doc2);
+	writer.flush();
+	@endcode
+	*/
+	template<typename Sink>
+	class JsonStreamWriter {
+	public:
+		///Initializes the writer
+		/**
+		@param sink function which receives the output
+		@param format unicode format
+		@param flushSize size of the buffer
+		*/
+		JsonStreamWriter(const Sink &sink, UnicodeFormat format = defaultUnicodeFormat,
+				std::size_t flushSize = SerializerBuffer<Sink>::defaultFlushSize)
+			:serializer(SerializerBuffer<Sink>(sink, flushSize), format == emitUtf8) {}
+
+		///Writes remaining buffered output. Errors of the sink are ignored, call flush() to receive them
+		~JsonStreamWriter() {
+			try {
+				flush();
+			}
+			catch (...) {
+			}
+		}
+
+		///Writes the document followed by the new line
+		void write(const Value &v) {
+			serializer.serialize(v);
+			serializer.getTarget()('\n');
+		}
+
+		///Passes the buffered output to the sink
+		void flush() {
+			serializer.getTarget().flush();
+		}
+
+	protected:
+		Serializer<SerializerBuffer<Sink> > serializer;
+
+		JsonStreamWriter(const JsonStreamWriter &) = delete;
+		JsonStreamWriter &operator=(const JsonStreamWriter &) = delete;
+	};
+
+}
@@ -0,0 +1,274 @@
+#include "jsonTape.h"
+#include "charScan.h"
+#include "parser.h"
+
+namespace json {
+
+	namespace {
+
+		const char *checkLiteral(const char *p, const char *end, const char *lit) {
+			while (*lit) {
+				if (p == end || *p != *lit) return nullptr;
+				++p;
+				++lit;
+			}
+			return p;
+		}
+
+		const char *checkDigits(const char *p, const char *end) {
+			if (p == end || *p < '0' || *p > '9') return nullptr;
+			do ++p; while (p != end && *p >= '0' && *p <= '9');
+			return p;
+		}
+
+		const char *checkNumber(const char *p, const char *end) {
+			if (*p == '-') ++p;
+			if (p != end && *p == '0') ++p;
+			else if ((p = checkDigits(p, end)) == nullptr) return nullptr;
+			if (p != end && *p == '.') {
+				if ((p = checkDigits(p + 1, end)) == nullptr) return nullptr;
+			}
+			if (p != end && (*p == 'e' || *p == 'E')) {
+				++p;
+				if (p != end && (*p == '+' || *p == '-')) ++p;
+				if ((p = checkDigits(p, end)) == nullptr) return nullptr;
+			}
+			return p;
+		}
+
+		bool isHex(char c) {
+			return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f') || (c >= 'A' && c <= 'F');
+		}
+
+		const char *checkString(const char *p, const char *end) {
+			++p;
+			for (;;) {
+				p = findStringSpecial(p, end);
+				if (p == end) return nullptr;
+				unsigned char c = (unsigned char)*p;
+				if (c == '"') return p + 1;
+				if (c == '\\') {
+					if (++p == end) return nullptr;
+					switch (*p) {
+					case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+						++p;
+						break;
+					case 'u':
+						for (int i = 0; i < 4; i++) {
+							if (++p == end || !isHex(*p)) return nullptr;
+						}
+						++p;
+						break;
+					default:
+						return nullptr;
+					}
+				} else if (c < 32) {
+					return nullptr;
+				} else {
+					//UTF-8 sequence
+					int cnt;
+					if (c >= 0xC2 && c <= 0xDF) cnt = 1;
+					else if (c >= 0xE0 && c <= 0xEF) cnt = 2;
+					else if (c >= 0xF0 && c <= 0xF4) cnt = 3;
+					else return nullptr;
+					++p;
+					for (int i = 0; i < cnt; i++, ++p) {
+						if (p == end || ((unsigned char)*p & 0xC0) != 0x80) return nullptr;
+					}
+				}
+			}
+		}
+
+		const char *checkScalar(const char *p, const char *end) {
+			switch (*p) {
+			case '"': return checkString(p, end);
+			case 't': return checkLiteral(p, end, "true");
+			case 'f': return checkLiteral(p, end, "false");
+			case 'n': return checkLiteral(p, end, "null");
+			default: return checkNumber(p, end);
+			}
+		}
+
+		///Open container of the scanned text
+		struct Open {
+			char close;
+			///value returned by the listener
+			std::size_t token;
+			///index of the current item
+			std::size_t index;
+			///opening quote of the current key (objects only)
+			const char *key;
+		};
+
+		///Description of the syntax error
+		struct ScanError {
+			const char *pos;
+			const char *message;
+		};
+
+		bool scanFail(ScanError &err, const char *pos, const char *message) {
+			err.pos = pos;
+			err.message = message;
+			return false;
+		}
+
+		const char *scalarError(char c) {
+			switch (c) {
+			case '"': return "Invalid string";
+			case 't':
+			case 'f':
+			case 'n': return "Unknown keyword";
+			default: return "Invalid number";
+			}
+		}
+
+		///Checks key and colon, moves p to the value
+		bool checkKey(const char *&p, const char *end, Open &open, ScanError &err) {
+			if (p == end) return scanFail(err, p, "Unexpected end of file");
+			if (*p != '"') return scanFail(err, p, "Expected a key (string)");
+			const char *q = checkString(p, end);
+			if (q == nullptr) return scanFail(err, p, "Invalid string");
+			open.key = p;
+			p = skipWhitespace(q, end);
+			if (p == end || *p != ':') return scanFail(err, p, "Expected ':'");
+			p = skipWhitespace(p + 1, end);
+			return true;
+		}
+
+		///Scans the text, reports containers to the listener
+		/**
+		The listener has functions std::size_t open(pos) and close(token, pos), where
+		the token is the value returned by the function open() for the same container.
+		The nesting is not limited by the stack, but by the maxNestingDepth
+
+		@param text text to scan
+		@param listener listener
+		@param stack stack of open containers. When the error is found, it contains the
+		containers around the error
+		@param err receives the error
+		@retval true text is valid
+		@retval false text is not valid
+		*/
+		template<typename Listener>
+		bool scanJson(const StringView<char> &text, Listener &listener, std::vector<Open> &stack, ScanError &err) {
+			const char *begin = text.data;
+			const char *end = begin + text.length;
+			const char *p = skipWhitespace(begin, end);
+			for (;;) {
+				//value expected
+				if (p == end) return scanFail(err, p, "Unexpected end of file");
+				char c = *p;
+				if (c == '{' || c == '[') {
+					if (stack.size() >= maxNestingDepth) return scanFail(err, p, "Too deep nesting");
+					char close = c == '{' ? '}' : ']';
+					std::size_t token = listener.open(p - begin);
+					p = skipWhitespace(p + 1, end);
+					if (p != end && *p == close) {
+						listener.close(token, p - begin);
+						++p;
+					} else {
+						stack.push_back(Open{close, token, 0, nullptr});
+						if (close == '}' && !checkKey(p, end, stack.back(), err)) return false;
+						continue;
+					}
+				} else {
+					const char *q = checkScalar(p, end);
+					if (q == nullptr) return scanFail(err, p, scalarError(c));
+					p = q;
+				}
+				//value complete, close containers or continue to next item
+				for (;;) {
+					p = skipWhitespace(p, end);
+					if (stack.empty()) return p == end || scanFail(err, p, "Unexpected text after the value");
+					Open &o = stack.back();
+					if (p == end) return scanFail(err, p, "Unexpected end of file");
+					if (*p == ',') {
+						//the key of the previous member is no longer valid
+						++o.index;
+						o.key = nullptr;
+						p = skipWhitespace(p + 1, end);
+						if (o.close == '}' && !checkKey(p, end, o, err)) return false;
+						break;
+					}
+					if (*p != o.close) return scanFail(err, p, o.close == '}' ? "Expected ',' or '}'" : "Expected ',' or ']'");
+					listener.close(o.token, p - begin);
+					stack.pop_back();
+					++p;
+				}
+			}
+		}
+
+		///Builds the path from the open containers, objects without a key are skipped
+		std::vector<ParseResult::PathItem> pathOfStack(const std::vector<Open> &stack, const StringView<char> &text) {
+			const char *end = text.data + text.length;
+			std::vector<ParseResult::PathItem> path;
+			for (const Open &o : stack) {
+				if (o.close == ']') {
+					path.push_back(ParseResult::PathItem{std::string(), o.index});
+				} else if (o.key) {
+					const char *e = checkString(o.key, end);
+					path.push_back(ParseResult::PathItem{std::string(o.key, e - o.key), o.index});
+				}
+			}
+			return path;
+		}
+
+		struct NoListener {
+			std::size_t open(std::size_t) {return 0;}
+			void close(std::size_t, std::size_t) {}
+		};
+
+		struct TapeListener {
+			std::vector<JsonTape::Container> &containers;
+			std::size_t open(std::size_t pos) {
+				containers.push_back(JsonTape::Container{pos, 0, 0});
+				return containers.size() - 1;
+			}
+			void close(std::size_t token, std::size_t pos) {
+				containers[token].close = pos;
+				containers[token].next = containers.size();
+			}
+		};
+
+	}
+
+	RefCntPtr<const JsonTape> JsonTape::create(const StringView<char> &text) {
+		JsonTape *tape = new JsonTape;
+		RefCntPtr<const JsonTape> res(tape);
+		TapeListener l{tape->containers};
+		std::vector<Open> stack;
+		ScanError err;
+		if (!scanJson(text, l, stack, err)) throw ParseError("Invalid JSON text");
+		return res;
+	}
+
+	bool JsonTape::validate(const StringView<char> &text) {
+		NoListener l;
+		std::vector<Open> stack;
+		ScanError err;
+		return scanJson(text, l, stack, err);
+	}
+
+	bool JsonTape::validate(const StringView<char> &text, ParseResult &error) {
+		NoListener l;
+		std::vector<Open> stack;
+		ScanError err;
+		if (scanJson(text, l, stack, err)) return true;
+		error = ParseResult(err.message, text, err.pos - text.data, pathOfStack(stack, text));
+		return false;
+	}
+
+	std::vector<ParseResult::PathItem> JsonTape::pathAt(const StringView<char> &text, std::size_t offset) {
+		//the scan of the text cut at the offset stops with the containers around the offset
+		NoListener l;
+		std::vector<Open> stack;
+		ScanError err;
+		scanJson(text.substr(0, offset), l, stack, err);
+		return pathOfStack(stack, text);
+	}
+
+	const char *JsonTape::skipScalar(const char *begin, const char *end) {
+		return checkScalar(begin, end);
+	}
+
+}
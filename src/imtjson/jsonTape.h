@@ -0,0 +1,75 @@
+#pragma once
+
+#include <vector>
+#include "refcnt.h"
+#include "stringview.h"
+#include "parseResult.h"
+
+namespace json {
+
+	///Structural index of JSON text
+	/** The index contains positions of all containers (objects and arrays) of the text in
+	the order of their opening brackets. It is built by a single pass, which also checks
+	the syntax of the text. No value is created, so the index can be used to find parts of
+	a large document and to parse only these parts (see LazyJsonValue).
+	*/
+	class JsonTape : public RefCntObj {
+	public:
+		///Container of the text
+		struct Container {
+			///offset of the opening bracket
+			std::size_t open;
+			///offset of the closing bracket
+			std::size_t close;
+			///index of the first container after this one and its nested containers
+			std::size_t next;
+		};
+
+		///Builds the index
+		/**
+		@param text JSON text, which contains exactly one value (with optional whitespaces)
+		@return the index
+		@exception ParseError the text is not valid JSON
+		*/
+		static RefCntPtr<const JsonTape> create(const StringView<char> &text);
+
+		///Checks syntax of the JSON text without building the index
+		/**
+		@param text text to check
+		@return true if the text contains exactly one valid JSON value (with optional whitespaces)
+		*/
+		static bool validate(const StringView<char> &text);
+		///Checks syntax of the JSON text and describes the error
+		/**
+		@param text text to check
+		@param error receives description of the error, it is not changed when the text is valid
+		@retval true the text is valid
+		@retval false the text is not valid
+		*/
+		static bool validate(const StringView<char> &text, ParseResult &error);
+		///Retrieves path to the value at given offset of the valid text
+		/**
+		@param text valid JSON text
+		@param offset offset inside of the text
+		@return path to the innermost value, which contains the offset (the outermost container is first)
+		*/
+		static std::vector<ParseResult::PathItem> pathAt(const StringView<char> &text, std::size_t offset);
+
+		///Finds end of string, number or literal. The value must be valid
+		/**
+		@param begin first character of the value
+		@param end end of the text
+		@return pointer after the value
+		*/
+		static const char *skipScalar(const char *begin, const char *end);
+
+		const Container &operator[](std::size_t index) const {return containers[index];}
+		std::size_t size() const {return containers.size();}
+
+	protected:
+		std::vector<Container> containers;
+	};
+
+	typedef RefCntPtr<const JsonTape> PJsonTape;
+
+}
@@ -0,0 +1,15 @@
+#include "keyIndex.h"
+
+namespace json {
+
+	std::uint32_t KeyIndex::hash(const StringView<char> &key) {
+		//FNV-1a
+		std::uint32_t h = 2166136261u;
+		for (char c : key) {
+			h ^= (unsigned char)c;
+			h *= 16777619u;
+		}
+		return h;
+	}
+
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include "stringview.h"
+
+namespace json {
+
+	///Hash index of the keys of a large object
+	/** Open addressing table, which maps hashes of the keys to the indexes of the members.
+	 * It is created by the object on the first lookup, when the object has at least
+	 * minMembers members. Smaller objects are searched by the binary search.
+	 */
+	class KeyIndex {
+	public:
+		///Objects smaller than this are not indexed
+		static const std::size_t minMembers = 32;
+		///Returned by find() when the key doesn't exist
+		static const std::size_t npos = std::size_t(-1);
+
+		///Creates index
+		/**
+		 * @param count count of members
+		 * @param keyAt function which returns key of the member at given index
+		 */
+		template<typename Fn>
+		KeyIndex(std::size_t count, const Fn &keyAt);
+
+		///Finds the member
+		/**
+		 * @param name name of the member
+		 * @param keyAt function which returns key of the member at given index
+		 * @return index of the member, or npos if not found
+		 */
+		template<typename Fn>
+		std::size_t find(const StringView<char> &name, const Fn &keyAt) const;
+
+		///Retrieves index stored in the object, creates it on the first use
+		/**
+		 * @param slot variable in the object, which holds the index. If more threads create the
+		 * index at the same time, only one index is stored, others are destroyed.
+		 * @param count count of members
+		 * @param keyAt function which returns key of the member at given index
+		 * @return the index
+		 */
+		template<typename Fn>
+		static const KeyIndex *get(std::atomic<KeyIndex *> &slot, std::size_t count, const Fn &keyAt);
+
+		///Calculates hash of the key
+		static std::uint32_t hash(const StringView<char> &key);
+
+	protected:
+		struct Slot {
+			std::uint32_t hash;
+			///index of the member + 1, zero is empty slot
+			std::uint32_t index;
+		};
+
+		std::vector<Slot> slots;
+		std::size_t mask;
+	};
+
+	template<typename Fn>
+	inline KeyIndex::KeyIndex(std::size_t count, const Fn &keyAt) {
+		//keep the table at most half full
+		std::size_t sz = 16;
+		while (sz < count * 2) sz <<= 1;
+		mask = sz - 1;
+		slots.resize(sz, Slot{0, 0});
+		for (std::size_t i = 0; i < count; i++) {
+			std::uint32_t h = hash(keyAt(i));
+			std::size_t pos = h & mask;
+			while (slots[pos].index) pos = (pos + 1) & mask;
+			slots[pos].hash = h;
+			slots[pos].index = (std::uint32_t)(i + 1);
+		}
+	}
+
+	template<typename Fn>
+	inline std::size_t KeyIndex::find(const StringView<char> &name, const Fn &keyAt) const {
+		std::uint32_t h = hash(name);
+		std::size_t pos = h & mask;
+		while (slots[pos].index) {
+			const Slot &s = slots[pos];
+			if (s.hash == h && keyAt(s.index - 1) == name) return s.index - 1;
+			pos = (pos + 1) & mask;
+		}
+		return npos;
+	}
+
+	template<typename Fn>
+	inline const KeyIndex *KeyIndex::get(std::atomic<KeyIndex *> &slot, std::size_t count, const Fn &keyAt) {
+		KeyIndex *idx = slot.load(std::memory_order_acquire);
+		if (idx) return idx;
+		KeyIndex *nidx = new KeyIndex(count, keyAt);
+		if (slot.compare_exchange_strong(idx, nidx, std::memory_order_acq_rel)) return nidx;
+		delete nidx;
+		return idx;
+	}
+
+}
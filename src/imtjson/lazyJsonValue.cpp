@@ -0,0 +1,94 @@
+#include <cstring>
+#include <vector>
+#include "lazyJsonValue.h"
+#include "charScan.h"
+#include "objectValue.h"
+#include "parser.h"
+#include "value.h"
+
+namespace json {
+
+	namespace {
+
+		///Parses scalar members of a container, one parser is used for all members
+		class MemberParser : public Parser<BufferSource> {
+		public:
+			MemberParser(const StringView<char> &json)
+				:Parser<BufferSource>(BufferSource(json)),begin(json.data) {}
+
+			///Parses the scalar value at the given position
+			Value scalarAt(const char *p) {
+				rd.seek(p - begin);
+				return parse();
+			}
+			///Decodes the key with escape sequences at the given position (at the opening quote)
+			Value keyAt(const char *p) {
+				rd.seek(p - begin + 1);
+				return Value(readString());
+			}
+
+		protected:
+			const char *begin;
+		};
+
+	}
+
+	Value LazyJsonValue::create(const String &text) {
+		PJsonTape tape = JsonTape::create(text);
+		StringView<char> str = text;
+		//scalar document has nothing to index
+		if (tape->size() == 0) return Value::fromSharedString(text);
+		const JsonTape::Container &root = (*tape)[0];
+		return PValue(new LazyJsonValue(text, str.substr(root.open, root.close + 1 - root.open), tape, 0));
+	}
+
+	LazyJsonValue::LazyJsonValue(const String &text, const StringView<char> &json, const PJsonTape &tape, std::size_t tapeIndex)
+		:RawJsonValue(text, json),tape(tape),tapeIndex(tapeIndex)
+	{
+	}
+
+	Value LazyJsonValue::parseJson() const {
+		const char *base = StringView<char>(text).data;
+		const char *p = json.data;
+		const char *end = json.data + json.length - 1;
+		bool isObject = *p == '{';
+		//nested containers follow in the tape in the order of their appearance
+		std::size_t nextChild = tapeIndex + 1;
+		std::vector<Value> values;
+		std::vector<StringView<char> > keys;
+		std::vector<Value> decodedKeys;
+		MemberParser parser(json);
+		p = skipWhitespace(p + 1, end);
+		while (p != end) {
+			if (isObject) {
+				const char *k = JsonTape::skipScalar(p, end);
+				StringView<char> key(p + 1, k - p - 2);
+				if (std::memchr(key.data, '\\', key.length)) {
+					decodedKeys.push_back(parser.keyAt(p));
+					key = decodedKeys.back().getString();
+				}
+				keys.push_back(key);
+				//skip the colon
+				p = skipWhitespace(skipWhitespace(k, end) + 1, end);
+			}
+			if (*p == '{' || *p == '[') {
+				const JsonTape::Container &c = (*tape)[nextChild];
+				const char *e = base + c.close + 1;
+				values.push_back(PValue(new LazyJsonValue(text, StringView<char>(p, e - p), tape, nextChild)));
+				nextChild = c.next;
+				p = e;
+			} else {
+				const char *e = JsonTape::skipScalar(p, end);
+				values.push_back(parser.scalarAt(p));
+				p = e;
+			}
+			//skip the comma
+			p = skipWhitespace(p, end);
+			if (p != end) p = skipWhitespace(p + 1, end);
+		}
+		StringView<Value> v(values.data(), values.size());
+		if (isObject) return CompactObjectValue::create(StringView<StringView<char> >(keys.data(), keys.size()), v);
+		return Value(array, v);
+	}
+
+}
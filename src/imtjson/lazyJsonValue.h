@@ -0,0 +1,40 @@
+#pragma once
+
+#include "jsonTape.h"
+#include "rawJsonValue.h"
+
+namespace json {
+
+	///Value of a lazily parsed document
+	/** The document is checked and indexed by the JsonTape at once, but the values are
+	created only for the parts which are accessed. The first access to the content of
+	a container (size(), member(), itemAtIndex(), enumItems()) creates its members. Scalar
+	members are parsed, nested containers become other LazyJsonValue objects, which are
+	not parsed until they are accessed. Nested containers are skipped through the index,
+	so their text is not scanned again.
+
+	All values share the text and the index. Because this is a RawJsonValue, the serializer
+	writes the text of the document (or its parts) without a change.
+	*/
+	class LazyJsonValue : public RawJsonValue {
+	public:
+		///Creates lazy document
+		/**
+		@param text JSON text
+		@return the root value of the document
+		@exception ParseError the text is not valid JSON
+		*/
+		static Value create(const String &text);
+
+	protected:
+		LazyJsonValue(const String &text, const StringView<char> &json, const PJsonTape &tape, std::size_t tapeIndex);
+
+		virtual Value parseJson() const override;
+
+		///index of the document
+		PJsonTape tape;
+		///index of the container in the tape
+		std::size_t tapeIndex;
+	};
+
+}
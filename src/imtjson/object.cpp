@@ -8,41 +8,6 @@
 
 namespace json {
 
-	class ObjectProxy : public AbstractValue {
-	public:
-
-		ObjectProxy(const StringView<char> &name, const PValue &value);
-		
-		virtual ValueType type() const override { return value->type(); }
-		virtual ValueTypeFlags flags() const override { return value->flags() | proxy; }
-
-		virtual std::uintptr_t getUInt() const override { return value->getUInt(); }
-		virtual std::intptr_t getInt() const override { return value->getInt(); }
-		virtual double getNumber() const override { return value->getNumber(); }
-		virtual bool getBool() const override { return value->getBool(); }
-		virtual StringView<char> getString() const override { return value->getString(); }
-		virtual std::size_t size() const override { return value->size(); }
-		virtual const IValue *itemAtIndex(std::size_t index) const override { return value->itemAtIndex(index); }
-		virtual const IValue *member(const StringView<char> &name) const override { return value->member(name); }
-		virtual bool enumItems(const IEnumFn &fn) const override { return value->enumItems(fn); }
-		virtual StringView<char> getMemberName() const override { return StringView<char>(key,keysize); }
-		virtual const IValue *unproxy() const override { return value->unproxy(); }
-		virtual bool equal(const IValue *other) const override {
-				return value->equal(other->unproxy());
-		}
-
-		void *operator new(std::size_t sz, const StringView<char> &str );
-		void operator delete(void *ptr, const StringView<char> &str);
-		void operator delete(void *ptr, std::size_t sz);
-
-	protected:
-		ObjectProxy(ObjectProxy &&) = delete;
-		PValue value;
-		std::size_t keysize;
-		char key[256];
-
-	};
-
 	ObjectProxy::ObjectProxy(const StringView<char> &name, const PValue &value):value(value),keysize(name.length) {
 		std::memcpy(key,name.data,name.length);
 		key[name.length] = 0;
@@ -405,7 +370,10 @@ Value Value::setKey(const StringView<char> &key) const {
 StringView<PValue> Object::getItems(const Value& v) {
 	const IValue *pv = v.getHandle();
 	const ObjectValue *ov = dynamic_cast<const ObjectValue *>(pv->unproxy());
-	if (ov) return ov->getItems(); else return StringView<PValue>();
+	if (ov) return ov->getItems();
+	const CompactObjectValue *cv = pv->unproxy()->asCompactObject();
+	if (cv) return cv->getItems();
+	return StringView<PValue>();
 }
 
 }
@@ -1,14 +1,22 @@
+#include <algorithm>
+#include <cstring>
+#include <limits>
 #include "objectValue.h"
+#include "value.h"
 
 namespace json {
 
 
 
 	ObjectValue::ObjectValue(const std::vector<PValue>& value)
-		:v(value)
+		:v(value),keyIndex(nullptr)
 	{
 	}
 
+	ObjectValue::~ObjectValue() {
+		delete keyIndex.load(std::memory_order_relaxed);
+	}
+
 
 	std::size_t ObjectValue::size() const
 	{
@@ -31,6 +39,12 @@ namespace json {
 
 	const IValue * ObjectValue::member(const StringView<char>& name) const
 	{
+		if (v.size() >= KeyIndex::minMembers) {
+			auto keyAt = [&](std::size_t i) {return v[i]->getMemberName();};
+			std::size_t pos = KeyIndex::get(keyIndex, v.size(), keyAt)->find(name, keyAt);
+			if (pos == KeyIndex::npos) return getUndefined();
+			return v[pos];
+		}
 		std::size_t l = 0;
 		std::size_t r = v.size();
 		while (l < r) {
@@ -49,8 +63,218 @@ namespace json {
 		return getUndefined();
 	}
 
-	ObjectValue::ObjectValue(std::vector<PValue>&& value):v(std::move(value)) {
+	ObjectValue::ObjectValue(std::vector<PValue>&& value):v(std::move(value)),keyIndex(nullptr) {
 	}
 
-}
+	PKeySet KeySet::create(const StringView<StringView<char> > &keys, const std::size_t *order, std::size_t count) {
+		std::size_t keyBytes = 0;
+		for (std::size_t i = 0; i < count; i++) keyBytes += keys[order ? order[i] : i].length;
+		std::size_t extra = (count + 1) * sizeof(std::uint32_t) + keyBytes;
+		return new(extra) KeySet(keys, order, count);
+	}
+
+	KeySet::KeySet(const StringView<StringView<char> > &keys, const std::size_t *order, std::size_t count)
+		:count(count),keyIndex(nullptr)
+	{
+		std::uint32_t *offs = offsets();
+		char *k = const_cast<char *>(chars());
+		std::uint32_t offset = 0;
+		for (std::size_t i = 0; i < count; i++) {
+			const StringView<char> &key = keys[order ? order[i] : i];
+			offs[i] = offset;
+			std::memcpy(k + offset, key.data, key.length);
+			offset += (std::uint32_t)key.length;
+		}
+		offs[count] = offset;
+	}
+
+	KeySet::~KeySet() {
+		delete keyIndex.load(std::memory_order_relaxed);
+	}
+
+	std::size_t KeySet::find(const StringView<char> &name) const {
+		if (count >= KeyIndex::minMembers) {
+			auto keyAt = [&](std::size_t i) {return (*this)[i];};
+			return KeyIndex::get(keyIndex, count, keyAt)->find(name, keyAt);
+		}
+		std::size_t l = 0;
+		std::size_t r = count;
+		while (l < r) {
+			std::size_t m = (l + r) / 2;
+			int c = name.compare((*this)[m]);
+			if (c > 0) {
+				l = m + 1;
+			}
+			else if (c < 0) {
+				r = m;
+			}
+			else {
+				return m;
+			}
+		}
+		return KeyIndex::npos;
+	}
 
+	void *KeySet::operator new(std::size_t sz, const std::size_t &extra) {
+		return Value::allocator->alloc(sz + extra);
+	}
+
+	void KeySet::operator delete(void *ptr, const std::size_t &) {
+		Value::allocator->dealloc(ptr);
+	}
+
+	void KeySet::operator delete(void *ptr, std::size_t) {
+		Value::allocator->dealloc(ptr);
+	}
+
+	PKeySet KeySetCache::get(const StringView<StringView<char> > &keys, const std::size_t *order, std::size_t count) {
+		std::uint32_t h = (std::uint32_t)count;
+		for (std::size_t i = 0; i < count; i++) {
+			h = h * 31 + KeyIndex::hash(keys[order ? order[i] : i]);
+		}
+		Entry &e = entries[h % cacheSize];
+		if (e.keySet != nullptr && e.hash == h && e.keySet->size() == count) {
+			const KeySet &ks = *e.keySet;
+			std::size_t i = 0;
+			while (i < count && ks[i] == keys[order ? order[i] : i]) i++;
+			if (i == count) return e.keySet;
+		}
+		e.hash = h;
+		e.keySet = KeySet::create(keys, order, count);
+		return e.keySet;
+	}
+
+	PValue CompactObjectValue::create(const StringView<StringView<char> > &keys, const StringView<Value> &values,
+			KeySetCache *cache) {
+		std::size_t n = keys.length;
+		if (n == 0) return AbstractObjectValue::getEmptyObject();
+		bool ordered = true;
+		for (std::size_t i = 1; i < n && ordered; i++) ordered = keys[i - 1].compare(keys[i]) < 0;
+		std::vector<std::size_t> order;
+		if (!ordered) {
+			order.reserve(n);
+			for (std::size_t i = 0; i < n; i++) order.push_back(i);
+			//stable sort keeps duplicated keys in original order, so the last one can be picked
+			std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+				return keys[a].compare(keys[b]) < 0;
+			});
+			std::size_t wrpos = 0;
+			for (std::size_t i = 0; i < n; i++) {
+				if (wrpos && keys[order[wrpos - 1]] == keys[order[i]]) wrpos--;
+				order[wrpos++] = order[i];
+			}
+			order.resize(wrpos);
+			n = wrpos;
+		}
+		const std::size_t *ord = ordered ? nullptr : order.data();
+		std::size_t keyBytes = 0;
+		for (std::size_t i = 0; i < n; i++) keyBytes += keys[ord ? ord[i] : i].length;
+		if (keyBytes > std::numeric_limits<std::uint32_t>::max()) {
+			//too long keys can't be stored in the key set
+			std::vector<Value> kv;
+			kv.reserve(n);
+			for (std::size_t i = 0; i < n; i++) {
+				std::size_t j = ord ? ord[i] : i;
+				kv.push_back(values[j].setKey(keys[j]));
+			}
+			return Value(object, StringView<Value>(kv.data(), kv.size())).getHandle();
+		}
+		PKeySet keySet = cache ? cache->get(keys, ord, n) : KeySet::create(keys, ord, n);
+		std::size_t extra = n * (sizeof(PValue) + sizeof(ProxySlot));
+		return new(extra) CompactObjectValue(keySet, values, ord);
+	}
+
+	CompactObjectValue::CompactObjectValue(const PKeySet &keySet, const StringView<Value> &values, const std::size_t *order)
+		:count(keySet->size()),keySet(keySet),items(nullptr)
+	{
+		static_assert(sizeof(CompactObjectValue) % alignof(PValue) == 0, "Values are not aligned");
+		PValue *v = this->values();
+		ProxySlot *p = proxies();
+		for (std::size_t i = 0; i < count; i++) {
+			new(v + i) PValue(values[order ? order[i] : i].getHandle()->unproxy());
+			new(p + i) ProxySlot(nullptr);
+		}
+	}
+
+	CompactObjectValue::~CompactObjectValue() {
+		PValue *v = values();
+		ProxySlot *p = proxies();
+		for (std::size_t i = 0; i < count; i++) {
+			const IValue *x = p[i].load(std::memory_order_acquire);
+			if (x && x->release()) delete x;
+			v[i].~PValue();
+		}
+		delete [] items.load(std::memory_order_acquire);
+	}
+
+	const IValue *CompactObjectValue::proxyAt(std::size_t index) const {
+		ProxySlot &slot = proxies()[index];
+		const IValue *x = slot.load(std::memory_order_acquire);
+		if (x) return x;
+		StringView<char> key = keyAt(index);
+		const IValue *nx = new(key) ObjectProxy(key, values()[index]);
+		nx->addRef();
+		if (slot.compare_exchange_strong(x, nx, std::memory_order_acq_rel)) return nx;
+		//other thread was faster
+		if (nx->release()) delete nx;
+		return x;
+	}
+
+	const IValue *CompactObjectValue::itemAtIndex(std::size_t index) const {
+		if (index < count) return proxyAt(index);
+		return getUndefined();
+	}
+
+	bool CompactObjectValue::enumItems(const IEnumFn &fn) const {
+		for (std::size_t i = 0; i < count; i++) {
+			if (!fn(proxyAt(i))) return false;
+		}
+		return true;
+	}
+
+	const IValue *CompactObjectValue::member(const StringView<char> &name) const {
+		std::size_t pos = keySet->find(name);
+		if (pos == KeyIndex::npos) return getUndefined();
+		return proxyAt(pos);
+	}
+
+	bool CompactObjectValue::equal(const IValue *other) const {
+		const CompactObjectValue *o = other->unproxy()->asCompactObject();
+		//objects sharing the keys need to compare only the values
+		if (o == nullptr || o->keySet != keySet) return AbstractObjectValue::equal(other);
+		for (std::size_t i = 0; i < count; i++) {
+			const IValue *a = valueAt(i);
+			const IValue *b = o->valueAt(i);
+			if (a != b && !a->equal(b)) return false;
+		}
+		return true;
+	}
+
+	StringView<PValue> CompactObjectValue::getItems() const {
+		const PValue *x = items.load(std::memory_order_acquire);
+		if (x == nullptr) {
+			PValue *nx = new PValue[count];
+			for (std::size_t i = 0; i < count; i++) nx[i] = proxyAt(i);
+			if (items.compare_exchange_strong(x, nx, std::memory_order_acq_rel)) {
+				x = nx;
+			} else {
+				//other thread was faster
+				delete [] nx;
+			}
+		}
+		return StringView<PValue>(x, count);
+	}
+
+	void *CompactObjectValue::operator new(std::size_t sz, const std::size_t &extra) {
+		return Value::allocator->alloc(sz + extra);
+	}
+
+	void CompactObjectValue::operator delete(void *ptr, const std::size_t &) {
+		Value::allocator->dealloc(ptr);
+	}
+
+	void CompactObjectValue::operator delete(void *ptr, std::size_t) {
+		Value::allocator->dealloc(ptr);
+	}
+
+}
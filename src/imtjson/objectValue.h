@@ -1,18 +1,25 @@
 #pragma once
 
+#include <atomic>
+#include <cstdint>
 #include <vector>
 #include "basicValues.h"
+#include "keyIndex.h"
+#include "serializedCache.h"
 
 namespace json {
 
 	class Object;
+	class Value;
 
-	class ObjectValue : public AbstractObjectValue {
+	class ObjectValue : public AbstractObjectValue, public SerializedCache {
 	public:
 
 		ObjectValue(const std::vector<PValue> &value);
 		ObjectValue(std::vector<PValue> &&value);
+		~ObjectValue();
 
+		virtual ValueTypeFlags flags() const override {return serializedCacheFlags();}
 		virtual std::size_t size() const override;
 		virtual const IValue *itemAtIndex(std::size_t index) const override;
 		virtual bool enumItems(const IEnumFn &) const override;
@@ -20,13 +27,215 @@ namespace json {
 
 		StringView<PValue> getItems() const { return v; }
 		virtual bool getBool() const override {return true;}
+		virtual const SerializedCache *getSerializedCache() const override {return this;}
 
 	protected:
 		std::vector<PValue> v;
+		///hash index of the keys, created by the first member() on a large object
+		mutable std::atomic<KeyIndex *> keyIndex;
 
 
 
 	};
 
+	///Carries the key with the value inside of an object
+	class ObjectProxy : public AbstractValue {
+	public:
+
+		ObjectProxy(const StringView<char> &name, const PValue &value);
+
+		virtual ValueType type() const override { return value->type(); }
+		virtual ValueTypeFlags flags() const override { return value->flags() | proxy; }
+
+		virtual std::uintptr_t getUInt() const override { return value->getUInt(); }
+		virtual std::intptr_t getInt() const override { return value->getInt(); }
+		virtual double getNumber() const override { return value->getNumber(); }
+		virtual bool getBool() const override { return value->getBool(); }
+		virtual StringView<char> getString() const override { return value->getString(); }
+		virtual std::size_t size() const override { return value->size(); }
+		virtual const IValue *itemAtIndex(std::size_t index) const override { return value->itemAtIndex(index); }
+		virtual const IValue *member(const StringView<char> &name) const override { return value->member(name); }
+		virtual bool enumItems(const IEnumFn &fn) const override { return value->enumItems(fn); }
+		virtual StringView<char> getMemberName() const override { return StringView<char>(key,keysize); }
+		virtual const IValue *unproxy() const override { return value->unproxy(); }
+		virtual bool equal(const IValue *other) const override {
+				return value->equal(other->unproxy());
+		}
+
+		void *operator new(std::size_t sz, const StringView<char> &str );
+		void operator delete(void *ptr, const StringView<char> &str);
+		void operator delete(void *ptr, std::size_t sz);
+
+	protected:
+		ObjectProxy(ObjectProxy &&) = delete;
+		PValue value;
+		std::size_t keysize;
+		char key[256];
+
+	};
+
+	///Sorted keys of an object
+	/** All keys are stored in a single block of memory. The key set is immutable, so it can
+	 * be shared by many objects with the same keys (see KeySetCache). The hash index of
+	 * a large key set is also shared.
+	 */
+	class KeySet : public RefCntObj {
+	public:
+		///Creates the key set
+		/**
+		 * @param keys keys
+		 * @param order indexes of the keys in sorted order, nullptr if the keys are already sorted
+		 * @param count count of the keys
+		 * @return key set
+		 */
+		static RefCntPtr<KeySet> create(const StringView<StringView<char> > &keys, const std::size_t *order, std::size_t count);
+
+		~KeySet();
+
+		std::size_t size() const {return count;}
+		StringView<char> operator[](std::size_t index) const {
+			const std::uint32_t *offs = offsets();
+			return StringView<char>(chars() + offs[index], offs[index + 1] - offs[index]);
+		}
+		///Finds the key
+		/** @return index of the key, or KeyIndex::npos if not found */
+		std::size_t find(const StringView<char> &name) const;
+
+		void *operator new(std::size_t sz, const std::size_t &extra);
+		void operator delete(void *ptr, const std::size_t &extra);
+		void operator delete(void *ptr, std::size_t sz);
+
+	protected:
+		std::size_t count;
+		///hash index of the keys, created by the first find() on a large key set
+		mutable std::atomic<KeyIndex *> keyIndex;
+
+		KeySet(const StringView<StringView<char> > &keys, const std::size_t *order, std::size_t count);
+		KeySet(KeySet &&) = delete;
+
+		///Offsets of the keys follow the object (count + 1 items)
+		std::uint32_t *offsets() const {
+			return reinterpret_cast<std::uint32_t *>(const_cast<KeySet *>(this) + 1);
+		}
+		///Characters follow the offsets
+		const char *chars() const {
+			return reinterpret_cast<const char *>(offsets() + count + 1);
+		}
+	};
+
+	typedef RefCntPtr<KeySet> PKeySet;
+
+	///Remembers recently created key sets, so objects with the same keys can share them
+	/** The parser uses the cache to share keys between objects of the same structure,
+	 * which is typical for arrays of records. The cache has fixed size, so it doesn't grow
+	 * for documents, where each object has different keys.
+	 */
+	class KeySetCache {
+	public:
+		///Retrieves key set from the cache, or creates new one
+		/**
+		 * @param keys keys
+		 * @param order indexes of the keys in sorted order, nullptr if the keys are already sorted
+		 * @param count count of the keys
+		 * @return key set
+		 */
+		PKeySet get(const StringView<StringView<char> > &keys, const std::size_t *order, std::size_t count);
+
+	protected:
+		static const std::size_t cacheSize = 64;
+
+		struct Entry {
+			std::uint32_t hash;
+			PKeySet keySet;
+		};
+
+		Entry entries[cacheSize];
+	};
+
+	///Object which stores all values in a single block of memory
+	/** Members are sorted by the key. The keys are stored in the KeySet, which can be shared
+	 * with other objects having the same keys. Searching the member doesn't need
+	 * to touch other memory than the key set. This object is created by the parser.
+	 *
+	 * The IValue interface returns members as the key-value proxies (itemAtIndex(), member(),
+	 * enumItems()). They are created lazily on the first access and they are kept with the object.
+	 * The serializer reads keys and values directly, so no proxy is created.
+	 */
+	class CompactObjectValue : public AbstractObjectValue, public SerializedCache {
+	public:
+
+		///Creates the object
+		/**
+		 * @param keys keys of the members
+		 * @param values values of the members, count of values must be same as count of keys
+		 * @param cache optional cache of the key sets, which allows to share keys between objects
+		 * @return the object. Members are sorted by the key. If there is a duplicated key, the last
+		 * one is used.
+		 */
+		static PValue create(const StringView<StringView<char> > &keys, const StringView<Value> &values,
+				KeySetCache *cache = nullptr);
+
+		~CompactObjectValue();
+
+		virtual ValueTypeFlags flags() const override {return serializedCacheFlags();}
+		virtual std::size_t size() const override {return count;}
+		virtual const IValue *itemAtIndex(std::size_t index) const override;
+		virtual bool enumItems(const IEnumFn &) const override;
+		virtual const IValue *member(const StringView<char> &name) const override;
+		virtual bool getBool() const override {return true;}
+		virtual bool equal(const IValue *other) const override;
+		virtual const CompactObjectValue *asCompactObject() const override {return this;}
+		virtual const SerializedCache *getSerializedCache() const override {return this;}
+
+		///Retrieves key of the member without creating the proxy
+		StringView<char> keyAt(std::size_t index) const {
+			return (*keySet)[index];
+		}
+		///Retrieves value of the member without creating the proxy (the value has no key)
+		const IValue *valueAt(std::size_t index) const {
+			return values()[index];
+		}
+		///Retrieves all members as proxies (creates all missing proxies)
+		/** The array of the proxies is created on the first call and it is kept until the object
+		 * is destroyed */
+		StringView<PValue> getItems() const;
+		///Retrieves keys of the object
+		const PKeySet &getKeySet() const {return keySet;}
+
+		void *operator new(std::size_t sz, const std::size_t &extra);
+		void operator delete(void *ptr, const std::size_t &extra);
+		void operator delete(void *ptr, std::size_t sz);
+
+	protected:
+		typedef std::atomic<const IValue *> ProxySlot;
+
+		///count of members
+		std::size_t count;
+		///keys of the members
+		PKeySet keySet;
+		///array of the proxies returned by getItems(), nullptr if it was not requested yet
+		mutable std::atomic<const PValue *> items;
+
+		///Constructs the object in the preallocated block
+		/**
+		 * @param keySet keys of the members
+		 * @param values values
+		 * @param order indexes of the members in the order of keys, nullptr if the keys are already ordered
+		 */
+		CompactObjectValue(const PKeySet &keySet, const StringView<Value> &values, const std::size_t *order);
+		CompactObjectValue(CompactObjectValue &&) = delete;
+
+		///Values follow the object
+		PValue *values() const {
+			return reinterpret_cast<PValue *>(const_cast<CompactObjectValue *>(this) + 1);
+		}
+		///Proxies follow the values
+		ProxySlot *proxies() const {
+			return reinterpret_cast<ProxySlot *>(values() + count);
+		}
+
+		const IValue *proxyAt(std::size_t index) const;
+	};
+
 
 }
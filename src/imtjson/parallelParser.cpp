@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <exception>
+#include <iterator>
+#include <sstream>
+#include <thread>
+#include "parallelParser.h"
+#include "charScan.h"
+#include "parser.h"
+
+namespace json {
+
+	namespace {
+
+		///Parses all values of the chunk
+		class ItemsParser : public Parser<BufferSource> {
+		public:
+			ItemsParser(const StringView<char> &text, bool commas)
+				:Parser<BufferSource>(BufferSource(text)),commas(commas) {}
+
+			///Parses the values
+			/** @param out receives the values. When an error is thrown, out contains the values
+			parsed before the error */
+			void parseItems(std::vector<Value> &out) {
+				//chunk of NDJSON can contain only empty lines
+				if (!commas && rd.nextWs() == (char)-1) return;
+				for (;;) {
+					out.push_back(parse());
+					char c = rd.nextWs();
+					if (c == (char)-1) return;
+					if (commas) {
+						if (c != ',') throw ParseError("Expected ',' or ']'");
+						rd.commit();
+					}
+				}
+			}
+
+		protected:
+			bool commas;
+		};
+
+	}
+
+	ParallelParser::ParallelParser(unsigned int threads, std::size_t minChunkSize)
+#ifdef IMTJSON_NONATOMIC_REFCNT
+		//values can't be passed between threads, the current thread parses everything
+		:threads(1)
+#else
+		:threads(threads ? threads : std::max(1u, std::thread::hardware_concurrency()))
+#endif
+		,minChunkSize(std::max<std::size_t>(minChunkSize, 1))
+	{
+	}
+
+	std::size_t ParallelParser::countChunks(std::size_t length) const {
+		if (threads < 2) return 1;
+		//more chunks than threads balance the load, when some chunks are parsed faster
+		return std::min<std::size_t>(threads * 4, length / minChunkSize);
+	}
+
+	Value ParallelParser::parseArray(const StringView<char> &text) const {
+		std::size_t chunkCount = countChunks(text.length);
+		if (chunkCount < 2) return Value::fromString(text);
+		//find commas which separate the items of the array
+		std::vector<std::size_t> commas;
+		std::vector<std::uint32_t> st;
+		StructuralScanner scanner(text.data, text.length);
+		std::size_t depth = 0;
+		std::size_t open = 0;
+		std::size_t close = 0;
+		while (close == 0 && scanner.next(st)) {
+			std::size_t base = scanner.getBase();
+			for (std::uint32_t offset : st) {
+				std::size_t pos = base + offset;
+				char c = text.data[pos];
+				if (depth == 0 && c != '[') return Value::fromString(text);
+				if (c == '{' || c == '[') {
+					if (depth++ == 0) open = pos;
+				} else if (c == '}' || c == ']') {
+					if (--depth == 0) {
+						close = pos;
+						break;
+					}
+				} else if (c == ',' && depth == 1) {
+					commas.push_back(pos);
+				}
+			}
+		}
+		//invalid or small array is parsed by the Parser, which also reports the error
+		if (close == 0 || text.data[close] != ']' || commas.empty()) return Value::fromString(text);
+		std::vector<StringView<char> > chunks;
+		std::size_t begin = open + 1;
+		for (std::size_t k = 1; k < chunkCount; k++) {
+			std::size_t target = open + (close - open) * k / chunkCount;
+			auto iter = std::lower_bound(commas.begin(), commas.end(), target);
+			if (iter == commas.end()) break;
+			//the item is larger than the chunk
+			if (*iter < begin) continue;
+			chunks.push_back(text.substr(begin, *iter - begin));
+			begin = *iter + 1;
+		}
+		chunks.push_back(text.substr(begin, close - begin));
+		return parseChunks(chunks, true);
+	}
+
+	Value ParallelParser::parseNDJSON(const StringView<char> &text) const {
+		std::size_t chunkCount = countChunks(text.length);
+		std::vector<StringView<char> > chunks;
+		std::size_t begin = 0;
+		std::size_t k = 1;
+		std::size_t target = text.length / std::max<std::size_t>(chunkCount, 1);
+		//splits the text at the first new line of the gap, which is after the target
+		//returns false when all chunks are found
+		auto splitGap = [&](std::size_t from, std::size_t to) {
+			while (k < chunkCount) {
+				std::size_t start = std::max(from, target);
+				if (start >= to) return true;
+				const char *nl = static_cast<const char *>(std::memchr(text.data + start, '\n', to - start));
+				if (nl == nullptr) return true;
+				std::size_t pos = nl - text.data + 1;
+				chunks.push_back(text.substr(begin, pos - begin));
+				begin = from = pos;
+				while (++k < chunkCount && (target = text.length * k / chunkCount) < pos) {}
+			}
+			return false;
+		};
+		if (chunkCount > 1) {
+			//values can span multiple lines, so only the new lines outside of containers
+			//are used. They are in the gaps between the structural characters
+			std::vector<std::uint32_t> st;
+			StructuralScanner scanner(text.data, text.length);
+			std::size_t depth = 0;
+			std::size_t gap = 0;
+			bool more = true;
+			while (more && scanner.next(st)) {
+				std::size_t base = scanner.getBase();
+				for (std::uint32_t offset : st) {
+					std::size_t pos = base + offset;
+					if (depth == 0 && !(more = splitGap(gap, pos))) break;
+					char c = text.data[pos];
+					if (c == '{' || c == '[') ++depth;
+					else if ((c == '}' || c == ']') && depth) --depth;
+					gap = pos + 1;
+				}
+			}
+			if (more && depth == 0) splitGap(gap, text.length);
+		}
+		chunks.push_back(text.substr(begin));
+		return parseChunks(chunks, false);
+	}
+
+	Value ParallelParser::parseChunks(const std::vector<StringView<char> > &chunks, bool commas) const {
+		struct Result {
+			std::vector<Value> items;
+			std::exception_ptr error;
+		};
+		std::vector<Result> results(chunks.size());
+		std::atomic<std::size_t> next(0);
+		auto worker = [&]() {
+			for (;;) {
+				std::size_t k = next.fetch_add(1);
+				if (k >= chunks.size()) break;
+				try {
+					ItemsParser parser(chunks[k], commas);
+					parser.parseItems(results[k].items);
+				}
+				catch (...) {
+					results[k].error = std::current_exception();
+				}
+			}
+		};
+		std::size_t cnt = std::min<std::size_t>(threads, chunks.size());
+		std::vector<std::thread> pool;
+		for (std::size_t i = 1; i < cnt; i++) pool.push_back(std::thread(worker));
+		worker();
+		for (std::thread &t : pool) t.join();
+
+		std::size_t total = 0;
+		for (Result &r : results) {
+			if (r.error) {
+				try {
+					std::rethrow_exception(r.error);
+				}
+				catch (ParseError &e) {
+					std::ostringstream buff;
+					buff << "[" << (total + r.items.size()) << "]";
+					e.addContext(buff.str());
+					throw;
+				}
+			}
+			total += r.items.size();
+		}
+		std::vector<Value> all;
+		all.reserve(total);
+		for (Result &r : results) {
+			all.insert(all.end(), std::make_move_iterator(r.items.begin()), std::make_move_iterator(r.items.end()));
+			r.items.clear();
+		}
+		return Value(array, StringView<Value>(all.data(), all.size()));
+	}
+
+}
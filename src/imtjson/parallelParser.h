@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include "value.h"
+
+namespace json {
+
+	///Parses large documents by multiple threads
+	/** The text is split into chunks at the boundaries of the items, the chunks are parsed by
+	a pool of threads and the items are assembled into one array in the original order.
+	Two kinds of documents can be split:
+
+	- top-level array. The boundaries are found by the structural index (see StructuralScanner),
+	so the commas inside of the strings and nested containers are not used
+	- newline delimited JSON (NDJSON) - or any sequence of JSON values separated by whitespaces.
+	Each chunk starts after a new line, which is found by the structural index outside of the
+	values, so the values can span multiple lines (for example pretty printed values)
+
+	The structural index is built in windows, so the text can be longer than 4GB. Small
+	documents are parsed by the current thread.
+
+	@note Values are created by the worker threads, so a ParseArena installed for the current
+	thread is not used. Strings of the result don't refer the text, the text can be
+	released after the parsing.
+
+	@note When the library is built with IMTJSON_NONATOMIC_REFCNT, values can't be passed
+	between threads. The parser then ignores the count of threads and the whole text is parsed
+	by the current thread.
+	*/
+	class ParallelParser {
+	public:
+		///Default minimal size of the chunk
+		static const std::size_t defaultMinChunkSize = 256 * 1024;
+
+		///Initializes the parser
+		/**
+		@param threads count of threads. Zero uses the count of hardware threads. It is always
+		one when the library is built with IMTJSON_NONATOMIC_REFCNT
+		@param minChunkSize minimal size of the chunk. The text is not split into smaller parts
+		*/
+		ParallelParser(unsigned int threads = 0, std::size_t minChunkSize = defaultMinChunkSize);
+
+		///Parses JSON text which contains an array
+		/**
+		@param text JSON text
+		@return parsed array. If the text doesn't contain an array, it is parsed as usual
+		@exception ParseError parsing error
+		*/
+		Value parseArray(const StringView<char> &text) const;
+
+		///Parses newline delimited JSON
+		/**
+		@param text text which contains zero or more JSON values separated by new lines
+		@return array of the parsed values
+		@exception ParseError parsing error
+		*/
+		Value parseNDJSON(const StringView<char> &text) const;
+
+	protected:
+		unsigned int threads;
+		std::size_t minChunkSize;
+
+		///Calculates count of chunks for the text of given length
+		std::size_t countChunks(std::size_t length) const;
+		///Parses the chunks and assembles the result
+		/**
+		@param chunks chunks of the text
+		@param commas true if the items are separated by commas
+		@return array of the items
+		*/
+		Value parseChunks(const std::vector<StringView<char> > &chunks, bool commas) const;
+	};
+
+}
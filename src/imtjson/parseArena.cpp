@@ -0,0 +1,77 @@
+#include <cstddef>
+#include <vector>
+#include "parseArena.h"
+#include "chunkOwner.h"
+#include "basicValues.h"
+
+namespace json {
+
+	static const std::size_t chunkSize = ChunkOwner::chunkSize;
+	///Larger blocks are allocated outside of the arena
+	static const std::size_t maxArenaBlock = chunkSize / 4;
+	///Blocks have the same alignment as blocks returned by the operator new
+	static const std::size_t blockAlign = alignof(std::max_align_t);
+
+
+	class Arena : public RefCntObj, public ChunkOwner {
+	public:
+		Arena() :pos(nullptr), limit(nullptr) {}
+		~Arena() {
+			for (char *c : chunks) freeChunk(c);
+		}
+
+		void *alloc(std::size_t sz) {
+			sz = (sz + blockAlign - 1) & ~(blockAlign - 1);
+			if (sz > maxArenaBlock) return nullptr;
+			if (sz > (std::size_t)(limit - pos) && !newChunk()) return nullptr;
+			void *r = pos;
+			pos += sz;
+			//every allocated block holds a reference to the arena
+			addRef();
+			return r;
+		}
+
+	protected:
+		char *pos;
+		char *limit;
+		std::vector<char *> chunks;
+
+		bool newChunk() {
+			char *c = allocChunk();
+			if (c == nullptr) return false;
+			chunks.push_back(c);
+			pos = c;
+			limit = c + chunkSize;
+			return true;
+		}
+
+		virtual void deallocBlock(void *) override {
+			if (release()) delete this;
+		}
+	};
+
+	static thread_local Arena *currentArena = nullptr;
+
+	ParseArena::ParseArena():arena(new Arena),prevArena(currentArena) {
+		//shared static values must not be allocated in the arena, otherwise they keep it forever
+		NullValue::getNull();
+		BoolValue::getBool(false);
+		BoolValue::getBool(true);
+		AbstractNumberValue::getZero();
+		AbstractStringValue::getEmptyString();
+		AbstractArrayValue::getEmptyArray();
+		AbstractObjectValue::getEmptyObject();
+		currentArena = arena;
+	}
+
+	ParseArena::~ParseArena() {
+		currentArena = prevArena;
+	}
+
+	void *ParseArena::allocCurrent(std::size_t sz) {
+		Arena *a = currentArena;
+		if (a == nullptr) return nullptr;
+		return a->alloc(sz);
+	}
+
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include "refcnt.h"
+
+namespace json {
+
+	class Arena;
+	typedef RefCntPtr<Arena> PArena;
+
+	///Allocates all values of a document from large chunks of memory
+	/** While an instance of this class exists, all values created by the current thread
+	 * through the default allocator are carved from large chunks of memory owned by the arena.
+	 * Destruction of an individual value doesn't release its memory. All chunks are released
+	 * at once, when the instance is destroyed and the last value allocated in the arena
+	 * is destroyed as well. So the values can safely outlive the instance.
+	 *
+	 * @code
+	 * Value doc;
+	 * {
+	 *     ParseArena arena;
+	 *     doc = Value::fromString(text);
+	 * }
+	 * //work with the doc
+	 * @endcode
+	 *
+	 * Arenas can be nested. Each thread has its own current arena, so values created by other
+	 * threads are not affected.
+	 *
+	 * @note Only values smaller than quarter of the chunk are allocated in the arena. Larger values
+	 * are allocated by the standard way. Values created in the arena keep all memory of the
+	 * arena allocated, so the arena should not be used for long living documents which
+	 * are gradually modified.
+	 */
+	class ParseArena {
+	public:
+		///Creates the arena and installs it for the current thread
+		ParseArena();
+		///Uninstalls the arena
+		/** The memory is released when the last value allocated in the arena is destroyed */
+		~ParseArena();
+
+		///Allocates memory from the arena installed for the current thread
+		/**
+		 * @param sz size of the block
+		 * @return pointer to the block, or nullptr, if there is no arena installed or the arena is
+		 * unable to allocate the block (so the caller must allocate it by other way)
+		 */
+		static void *allocCurrent(std::size_t sz);
+
+	protected:
+		PArena arena;
+		Arena *prevArena;
+
+		ParseArena(const ParseArena &) = delete;
+		ParseArena &operator=(const ParseArena &) = delete;
+	};
+
+}
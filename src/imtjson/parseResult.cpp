@@ -0,0 +1,47 @@
+#include "parseResult.h"
+#include "intConv.h"
+
+namespace json {
+
+	ParseResult::ParseResult()
+		:ok(false),offset(0),line(1),column(1)
+	{
+	}
+
+	ParseResult::ParseResult(const Value &value)
+		:ok(true),value(value),offset(0),line(0),column(0)
+	{
+	}
+
+	ParseResult::ParseResult(const std::string &message, const StringView<char> &text, std::size_t offset,
+			std::vector<PathItem> &&path)
+		:ok(false),message(message),offset(offset),line(1),column(1),path(std::move(path))
+	{
+		std::size_t lineStart = 0;
+		for (std::size_t i = 0; i < offset; i++) {
+			if (text[i] == '\n') {
+				++line;
+				lineStart = i + 1;
+			}
+		}
+		column = offset - lineStart + 1;
+	}
+
+	std::string ParseResult::getPath() const {
+		std::string res = "<root>";
+		for (const PathItem &item : path) {
+			res.append("/");
+			if (item.rawKey.empty()) {
+				char buff[formatIntBufferSize];
+				char *end = formatUnsigned(item.index, buff);
+				res.append("[").append(buff, end - buff).append("]");
+			} else {
+				//keys are decoded only when the path is requested
+				Value key = Value::fromString(item.rawKey);
+				res.append(key.getString().data, key.getString().length);
+			}
+		}
+		return res;
+	}
+
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include "value.h"
+
+namespace json {
+
+	///Result of the parsing, which doesn't throw exceptions (see Value::tryFromString())
+	/** The result contains either the parsed value, or description of the error: the message,
+	the position in the text and the path to the value where the error has been found.
+
+	@code
+	ParseResult res = Value::tryFromString(body);
+	if (!res) {
+		log("Invalid request at line ", res.getLine(), ": ", res.getMessage(), " ", res.getPath());
+		return;
+	}
+	Value req = res.getValue();
+	@endcode
+	*/
+	class ParseResult {
+	public:
+		///Item of the path to the error
+		struct PathItem {
+			///key of the member as it is in the text (including the quotes), empty for an item of array
+			std::string rawKey;
+			///index of the item of array
+			std::size_t index;
+		};
+
+		///Creates empty error result
+		ParseResult();
+		///Creates successful result
+		explicit ParseResult(const Value &value);
+		///Creates error result
+		/**
+		@param message description of the error
+		@param text parsed text, it is used to calculate the line and the column
+		@param offset offset of the character where the error has been found
+		@param path path to the error, the outermost container is first
+		*/
+		ParseResult(const std::string &message, const StringView<char> &text, std::size_t offset,
+				std::vector<PathItem> &&path = std::vector<PathItem>());
+
+		///Returns true, when the text has been parsed
+		bool isOk() const { return ok; }
+		///Returns true, when the text has been parsed
+		explicit operator bool() const { return ok; }
+
+		///Retrieves parsed value (undefined in case of the error)
+		const Value &getValue() const { return value; }
+		///Retrieves description of the error
+		const std::string &getMessage() const { return message; }
+		///Retrieves offset of the character where the error has been found
+		std::size_t getOffset() const { return offset; }
+		///Retrieves line number of the error (starting by 1)
+		std::size_t getLine() const { return line; }
+		///Retrieves column number of the error in bytes (starting by 1)
+		std::size_t getColumn() const { return column; }
+		///Retrieves path to the error
+		/** The path is built on request, in the same format as the context of the ParseError,
+		for example <root>/items/[3]/name */
+		std::string getPath() const;
+
+	protected:
+		bool ok;
+		Value value;
+		std::string message;
+		std::size_t offset;
+		std::size_t line;
+		std::size_t column;
+		std::vector<PathItem> path;
+	};
+
+}
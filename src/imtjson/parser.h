@@ -1,95 +1,397 @@
 #pragma once
 
+#include <cmath>
 #include <sstream>
 #include "object.h"
 #include "array.h"
+#include "objectValue.h"
+#include "charScan.h"
+#include "doubleConv.h"
+#include "intConv.h"
 
 namespace json {
 
-	template<typename Fn>
-	class Parser {
+	///Specifies default engine used by Value::fromString() and Value::fromBuffer()
+	/** Default is parserStreaming */
+	extern ParserEngine defaultParserEngine;
+
+	///Contiguous source of characters for the parser
+	/** The source refers already loaded text. The parser reads the text directly
+	through the pointers without calling a function for each character. It is used
+	by Value::fromString(), Value::fromBuffer() and Value::fromFile()
+
+	@code
+	Value v = Value::parse(BufferSource(text, length));
+	@endcode
+	*/
+	class BufferSource {
 	public:
+		BufferSource(const char *data, std::size_t length) :data(data), length(length) {}
+		BufferSource(const StringView<char> &text) :data(text.data), length(text.length) {}
 
-		Parser(const Fn &source) :rd(source) {}
+		const char *data;
+		std::size_t length;
+	};
 
-		virtual Value parse();
-		Value parseObject();
-		Value parseArray();
-		Value parseTrue();
-		Value parseFalse();
-		Value parseNull();
-		Value parseNumber();
-		Value parseString();
+	///Reads characters for the parser from a source function
+	template<typename Fn>
+	class ParserReader {
+		///source iterator
+		Fn source;
+		///temporary stored char here
+		char c;
+		///true if char is loaded, false if not
+		/** It could be possible to avoid such a flag if the commit()
+		  performs preload of the next character. However this can be a trap.
+		  If the character '}' of the top-level object is the last character
+		  in the stream before it blocks, the commit() should not read the
+		  next character. However it must be commited, because the inner parser
+		  doesn't know anything about on which level operates.
 
-		std::string readString();
-		void checkString(const StringView<char> &str);
+		  Other reason is that any preloaded character is also lost when the
+		  parser exits. And this preloaded character might be very important for
+		  any following code.
+		  */
+			    
+		bool loaded;
 
-	
 
-	protected:
+	public:
+		char next() {
+			//if char is not loaded, load it now
+			if (!loaded) {
+				//load
+				c = source();
+				//mark loaded
+				loaded = true;
+			}
+			//return char
+			return c;
+		}
 
-		class Reader {
-			///source iterator
-			Fn source;
-			///temporary stored char here
-			char c;
-			///true if char is loaded, false if not
-			/** It could be possible to avoid such a flag if the commit()
-			  performs preload of the next character. However this can be a trap.
-			  If the character '}' of the top-level object is the last character
-			  in the stream before it blocks, the commit() should not read the
-			  next character. However it must be commited, because the inner parser
-			  doesn't know anything about on which level operates.
-
-			  Other reason is that any preloaded character is also lost when the
-			  parser exits. And this preloaded character might be very important for
-			  any following code.
-			  */
-			    
-			bool loaded;
+		char nextWs() {
+			char n = next();
+			while (isspace(n)) { commit(); n = next(); }
+			return n;
+		}
 
+		void commit() {
+			//just mark character not loaded, which causes, that next() will load next character
+			loaded = false;
+		}
 
-		public:
-			char next() {
-				//if char is not loaded, load it now
-				if (!loaded) {
-					//load
-					c = source();
-					//mark loaded
-					loaded = true;
-				}
-				//return char
+		char nextCommit() {
+			//if not loaded
+			if (!loaded) {
+				//load it but keep in not-loaded state, this does mean 'autocommit'
+				return source();
+			} 
+			else {
+				//commit the character
+				loaded = false;
+				//return it
 				return c;
 			}
+		}
 
-			char nextWs() {
-				char n = next();
-				while (isspace(n)) { commit(); n = next(); }
-				return n;
+		///Appends characters of the string which don't need special processing
+		/** Function stops on quotes, backslash, any UTF-8 byte or end of the stream. The
+		stopping character is not extracted
+		@param out string where characters are appended
+		*/
+		void readPlainRun(std::string &out) {
+			char n = next();
+			while (n != '"' && n != '\\' && (n & 0x80) == 0) {
+				out.push_back(n);
+				commit();
+				n = next();
 			}
+		}
 
-			void commit() {
-				//just mark character not loaded, which causes, that next() will load next character
-				loaded = false;
+		///Appends decimal digits
+		/** Function stops on first non-digit character, which is not extracted
+		@param out string where characters are appended
+		*/
+		void readDigits(std::string &out) {
+			char n = next();
+			while (n >= '0' && n <= '9') {
+				out.push_back(n);
+				commit();
+				n = next();
 			}
+		}
+
+		ParserReader(const Fn &fn) :source(fn), loaded(false) {}
+	};
+
+	///Reads characters for the parser directly from the contiguous buffer
+	/** There is no function call and no flag per character. Whitespaces and
+	plain parts of the strings are processed in bulk (see charScan.h) */
+	template<>
+	class ParserReader<BufferSource> {
+		///first character of the buffer
+		const char *start;
+		///current read position
+		const char *pos;
+		///end of the buffer
+		const char *end;
+
+	public:
+		char next() {
+			return pos != end ? *pos : (char)-1;
+		}
 
-			char nextCommit() {
-				//if not loaded
-				if (!loaded) {
-					//load it but keep in not-loaded state, this does mean 'autocommit'
-					return source();
-				} 
+		char nextWs() {
+			//single whitespaces are common, longer runs (indentation) are skipped in bulk
+			if (pos != end && isJsonWhitespace(*pos)) {
+				++pos;
+				if (pos != end && isJsonWhitespace(*pos)) pos = skipWhitespace(pos, end);
+			}
+			return next();
+		}
+
+		void commit() {
+			if (pos != end) ++pos;
+		}
+
+		char nextCommit() {
+			return pos != end ? *pos++ : (char)-1;
+		}
+
+		void readPlainRun(std::string &out) {
+			const char *p = findSpecial(pos);
+			out.append(pos, p);
+			pos = p;
+		}
+
+		void readDigits(std::string &out) {
+			const char *p = pos;
+			while (p != end && *p >= '0' && *p <= '9') ++p;
+			out.append(pos, p);
+			pos = p;
+		}
+
+		///Extracts the string if it can be referenced directly in the buffer
+		/** The string must not contain an escape sequence. Non-ASCII characters
+		are accepted only when they are valid UTF-8 in the shortest form, so
+		the parser would store them unchanged.
+		@param out receives the content of the string (without quotes)
+		@retval true string extracted including the closing quotes
+		@retval false string must be processed by the parser, nothing extracted
+		*/
+		bool readPlainString(StringView<char> &out) {
+			const char *p = pos;
+			for (;;) {
+				p = findSpecial(p);
+				if (p == end) return false;
+				char c = *p;
+				if (c == '"') {
+					out = StringView<char>(pos, p - pos);
+					pos = p + 1;
+					return true;
+				}
+				else if (c == '\\') {
+					return false;
+				}
+				else if (c & 0x80) {
+					p = skipShortestUtf8(p);
+					if (p == nullptr) return false;
+				}
 				else {
-					//commit the character
-					loaded = false;
-					//return it
-					return c;
+					//control characters are stored as they are
+					++p;
 				}
 			}
+		}
+
+		///Moves the read position
+		/** @param offset offset from the beginning of the buffer */
+		void seek(std::size_t offset) { pos = start + offset; }
+
+		///Retrieves count of bytes extracted from the buffer
+		/** After the value is parsed, this is offset of the first unprocessed character */
+		std::size_t consumed() const { return pos - start; }
+
+		ParserReader(const BufferSource &src) :start(src.data), pos(src.data), end(src.data + src.length) {}
+
+	protected:
+		///Finds next special character of the string (see isStringSpecial())
+		const char *findSpecial(const char *p) const {
+			//short strings are checked directly, long strings are scanned by SIMD
+			const char *e = end - p > 16 ? p + 16 : end;
+			while (p != e && !isStringSpecial(*p)) ++p;
+			if (p == e && p != end) p = findStringSpecial(p, end);
+			return p;
+		}
+
+		///Skips UTF-8 sequence if it is encoded in the shortest form
+		/** @return pointer after the sequence, or nullptr if the sequence is invalid or
+		 not in the shortest form */
+		const char *skipShortestUtf8(const char *p) const {
+			unsigned char c = (unsigned char)*p;
+			std::size_t len;
+			unsigned char minSecond = 0x80, maxSecond = 0xBF;
+			if (c >= 0xC2 && c <= 0xDF) len = 2;
+			else if (c >= 0xE0 && c <= 0xEF) { len = 3; if (c == 0xE0) minSecond = 0xA0; }
+			else if (c >= 0xF0 && c <= 0xF4) {
+				len = 4;
+				if (c == 0xF0) minSecond = 0x90;
+				else if (c == 0xF4) maxSecond = 0x8F;
+			}
+			else return nullptr;
+			if ((std::size_t)(end - p) < len) return nullptr;
+			unsigned char second = (unsigned char)p[1];
+			if (second < minSecond || second > maxSecond) return nullptr;
+			for (std::size_t i = 2; i < len; i++) {
+				if ((p[i] & 0xC0) != 0x80) return nullptr;
+			}
+			return p + len;
+		}
+	};
+
+
+	///Source of characters which provides the input in blocks
+	/** The function fn has the signature StringView<char> fn(std::size_t used). It
+	receives count of characters used from the previous block and returns the next block.
+	The block must stay valid until the next call. The function returns empty block at
+	the end of the input. The parser reads the blocks directly, as the BufferSource.
+
+	After the value is parsed, count of characters used from the last block is
+	available through the reader (see ParserReader<BlockSource<Fn> >::blockUsed())
+	*/
+	template<typename Fn>
+	class BlockSource {
+	public:
+		BlockSource(const Fn &fn) :fn(fn) {}
+
+		Fn fn;
+	};
+
+	///Reads characters for the parser from the blocks of the BlockSource
+	template<typename Fn>
+	class ParserReader<BlockSource<Fn> > {
+		Fn fn;
+		///first character of the current block
+		const char *start;
+		///current read position
+		const char *pos;
+		///end of the current block
+		const char *end;
+		///count of characters in the previous blocks
+		std::size_t before;
+
+	public:
+		char next() {
+			return pos != end || fill() ? *pos : (char)-1;
+		}
+
+		char nextWs() {
+			for (;;) {
+				pos = skipWhitespace(pos, end);
+				if (pos != end || !fill()) return next();
+			}
+		}
+
+		void commit() {
+			if (pos != end) ++pos;
+		}
+
+		char nextCommit() {
+			return pos != end || fill() ? *pos++ : (char)-1;
+		}
+
+		void readPlainRun(std::string &out) {
+			for (;;) {
+				const char *p = findStringSpecial(pos, end);
+				out.append(pos, p);
+				pos = p;
+				if (pos != end || !fill()) return;
+			}
+		}
+
+		void readDigits(std::string &out) {
+			for (;;) {
+				const char *p = pos;
+				while (p != end && *p >= '0' && *p <= '9') ++p;
+				out.append(pos, p);
+				pos = p;
+				if (pos != end || !fill()) return;
+			}
+		}
+
+		///Retrieves count of characters extracted from all blocks
+		std::size_t consumed() const { return before + (pos - start); }
+		///Retrieves count of characters extracted from the current block
+		std::size_t blockUsed() const { return pos - start; }
+		///Forgets the current block
+		/** The next character is read from a new block, the source receives zero as count
+		of the used characters
+		@return count of characters extracted from the block. The source should take back
+		the rest of the block */
+		std::size_t releaseBlock() {
+			std::size_t used = pos - start;
+			before += used;
+			start = pos = end = nullptr;
+			return used;
+		}
+
+		ParserReader(const BlockSource<Fn> &src)
+			:fn(src.fn), start(nullptr), pos(nullptr), end(nullptr), before(0) {}
+
+	protected:
+		///Requests next block
+		/** @retval false end of the input */
+		bool fill() {
+			before += pos - start;
+			StringView<char> block = fn(static_cast<std::size_t>(pos - start));
+			start = pos = block.data;
+			end = block.data + block.length;
+			return block.length != 0;
+		}
+	};
+
+
+	class ParseError;
+
+	template<typename Fn>
+	class Parser {
+	public:
+
+		Parser(const Fn &source) :rd(source) {}
 
-			Reader(const Fn &fn) :source(fn), loaded(false) {}
+		virtual Value parse();
+		Value parseObject();
+		Value parseArray();
+		Value parseTrue();
+		Value parseFalse();
+		Value parseNull();
+		Value parseNumber();
+		///Parses the string value, the opening quote is already extracted
+		/** The function is called for all string values (not keys) of the document */
+		virtual Value parseString();
+
+		std::string readString();
+		void checkString(const StringView<char> &str);
+
+		///Number extracted from the stream
+		struct NumberToken {
+			///numberUnsignedInteger, numberInteger or zero for floating point number
+			ValueTypeFlags kind;
+			///value of unsigned integer
+			std::uintptr_t u;
+			///value of signed integer
+			std::intptr_t i;
+			///value of floating point number
+			double d;
 		};
 
+		typedef ParserReader<Fn> Reader;
+
+		///Retrieves the reader (for example to find position after parsed value)
+		const Reader &getReader() const { return rd; }
+
+	protected:
+
 		Reader rd;
 
 		///parses unsigned from the stream
@@ -100,22 +402,6 @@ namespace json {
 		@retval false number is not complete, parser stopped on integer overflow
 		*/	    
 		bool parseUnsigned(uintptr_t &res, int &counter);
-		///parses integer and stores result to the double
-		/** By storing result into double causes, that final number will rounded
-		  @param intPart already parsed pard by parseUnsigned
-		  @return parsed number as double
-		  @note function stops on first non-digit character (including dot)
-		*/
-		double parseLargeUnsigned(uintptr_t intPart);
-		///Parses decimal part
-		/**
-			works similar as parseLargeUnsigned, but result is number between 0 and 1
-			(mantisa). Function stops on first non-digit character (including dot, so
-			dot must be already extacted)
-
-			@return parsed mantisa
-		*/
-		double parseDecimalPart();
 		///Parse number and store it as floating point number
 		/**
 		 @param intpart part parsed by parseUnsigned. It can be however 0 to start
@@ -126,6 +412,15 @@ namespace json {
 		 caller already used readSign() function
 		*/
 		Value parseDouble(uintptr_t intpart, bool neg);
+		///Parses number and stores it to the token
+		/** Same as parseNumber(), but no value is created */
+		void readNumber(NumberToken &n);
+		///Parses floating point number (see parseDouble()), returns the number with the sign
+		double readDouble(uintptr_t intpart, bool neg);
+		///Parses the string into the tmpstr
+		/** Expects that the opening quote is already extracted. Returns reference to tmpstr,
+		which is valid until the next string is parsed */
+		const std::string &readTmpString();
 		///Reads sign '+' or '-' from the stream
 		/**
 		@retval true there were sign '-'.
@@ -145,12 +440,63 @@ namespace json {
 		char readNextUtf8();
 		///Stores unicode character as UTF-8 into the tmpstr
 		void storeUnicode(uintptr_t uchar);
+		///Open container
+		struct Level {
+			bool isObject;
+			///position of the first item in the tmpArr
+			std::size_t arrPos;
+			///position of the first key in the tmpKeyOffs
+			std::size_t keyPos;
+			///length of the tmpKeys before the first key
+			std::size_t keysLen;
+		};
+
+		///Parses values until the stack of open containers returns to the base
+		/**
+		@param base count of levels, which are not closed by this call
+		@param key true if a key is expected first (the object has just been opened)
+		@return the value which completed the level base
+		@exception ParseError parsing error. Keys and indexes of the levels above the base are
+		added to the context and the levels are removed
+		*/
+		Value parseLevels(std::size_t base, bool key);
+		///Parses the key and the colon, stores the key to the tmpKeys
+		void parseKey();
+		///Opens new container
+		/** @exception ParseError the nesting is too deep (see maxNestingDepth) */
+		void pushLevel(bool isObject);
+		///Creates the container from the collected items, removes the level
+		Value finishLevel();
+		///Adds keys and indexes of the open containers above the base to the error
+		void addContext(ParseError &e, std::size_t base) const;
+		///Creates object from the keys and values collected in the temporary buffers
+		/**
+		@param arrPos position of the first value in the tmpArr
+		@param keyPos position of the first key in the tmpKeyOffs
+		@param keysLen length of the tmpKeys before the first key
+		@return the object. Keys and values are removed from the buffers
+		*/
+		Value finishObject(std::size_t arrPos, std::size_t keyPos, std::size_t keysLen);
+		///Creates array from the values collected in the tmpArr, removes the values from the tmpArr
+		Value finishArray(std::size_t arrPos);
 
 		///Temporary string - to keep allocated memory
 		std::string tmpstr;
+		///Text of the number being parsed
+		std::string tmpnum;
 
 		///Temporary array - to keep allocated memory
 		std::vector<Value> tmpArr;
+		///Keys of objects being parsed - all keys are stored one after other
+		std::string tmpKeys;
+		///Offsets of the keys in the tmpKeys
+		std::vector<std::size_t> tmpKeyOffs;
+		///Keys of the finished object
+		std::vector<StringView<char> > tmpKeyViews;
+		///Objects with the same keys share the keys
+		KeySetCache keySets;
+		///Stack of open containers
+		std::vector<Level> levels;
 	};
 
 
@@ -158,6 +504,9 @@ namespace json {
 	public:
 		ParseError(std::string msg) :msg(msg) {}
 
+		///Retrieves the message without the context
+		const std::string &getMessage() const { return msg; }
+
 		virtual char const* what() const throw() {
 			if (whatmsg.empty()) {
 				whatmsg = "Parse error: '" + msg + "' at <root>";
@@ -197,114 +546,170 @@ namespace json {
 	template<typename Fn>
 	inline Value Parser<Fn>::parse()
 	{
-		char c = rd.nextWs();
-		switch (c) {
-			case '{': rd.commit(); return parseObject();
-			case '[': rd.commit(); return parseArray();
-			case '"': rd.commit(); return parseString();
-			case 't': return parseTrue();
-			case 'f': return parseFalse();
-			case 'n': return parseNull();
-			default: return parseNumber();
-		}
+		return parseLevels(levels.size(), false);
 	}
 
 	template<typename Fn>
 	inline Value Parser<Fn>::parseObject()
 	{
-		std::size_t tmpArrPos = tmpArr.size();
-		char c = rd.nextWs();
-		if (c == '}') {
+		std::size_t base = levels.size();
+		if (rd.nextWs() == '}') {
 			rd.commit();
 			return Value(object);
 		}
-		std::string name;
-		bool cont;
-		do {
-			if (c != '"') 
-				throw ParseError("Expected a key (string)");
-			rd.commit();
-			try {
-				name = readString();
-			}
-			catch (ParseError &e) {
-				e.addContext(name);
-			}
-			try {
-				if (rd.nextWs() != ':') 
-					throw ParseError("Expected ':'");
-				rd.commit();
-				Value v = parse();
-				tmpArr.push_back(v.setKey(name));
-			}
-			catch (ParseError &e) {
-				e.addContext(name);
-				throw;
-			}
-			c = rd.nextWs();
-			rd.commit();
-			if (c == '}') {
-				cont = false; 
-			}
-			else if (c == ',') {
-				cont = true;
-				c = rd.nextWs();
-			} 
-			else {
-				throw ParseError("Expected ',' or '}'");
-			}
-		} while (cont);		
-		StringView<Value> data = tmpArr;
-		Value res(object, data.substr(tmpArrPos));
-		tmpArr.resize(tmpArrPos);
-		return res;
+		pushLevel(true);
+		return parseLevels(base, true);
 	}
 
 	template<typename Fn>
 	inline Value Parser<Fn>::parseArray()
 	{
-		std::size_t tmpArrPos = tmpArr.size();
-		char c = rd.nextWs();
-		if (c == ']') {
+		std::size_t base = levels.size();
+		if (rd.nextWs() == ']') {
 			rd.commit();
 			return Value(array);
 		}
-		bool cont;
-		do {
-			try {
-				tmpArr.push_back(parse());
-			}
-			catch (ParseError &e) {
-				std::ostringstream buff;
-				buff << "[" << (tmpArr.size()-tmpArrPos) << "]";
-				e.addContext(buff.str());
-				throw;
-			}
-			try {
-				c = rd.nextWs();
-				rd.commit();
-				if (c == ']') {
-					cont = false;
-				}
-				else if (c == ',') {
-					cont = true;
+		pushLevel(false);
+		return parseLevels(base, false);
+	}
+
+	template<typename Fn>
+	inline Value Parser<Fn>::parseLevels(std::size_t base, bool key)
+	{
+		try {
+			if (key) parseKey();
+			for (;;) {
+				//value is expected
+				Value v;
+				char c = rd.nextWs();
+				switch (c) {
+					case '{':
+					case '[': {
+						rd.commit();
+						bool isObject = c == '{';
+						if (rd.nextWs() == (isObject ? '}' : ']')) {
+							rd.commit();
+							v = Value(isObject ? object : array);
+							break;
+						}
+						pushLevel(isObject);
+						if (isObject) parseKey();
+						continue;
+					}
+					case '"': rd.commit(); v = parseString(); break;
+					case 't': v = parseTrue(); break;
+					case 'f': v = parseFalse(); break;
+					case 'n': v = parseNull(); break;
+					default: v = parseNumber(); break;
 				}
-				else {
-					throw ParseError("Expected ',' or ']'");
+				//value is complete, close containers or continue to the next item
+				for (;;) {
+					if (levels.size() == base) return v;
+					tmpArr.push_back(v);
+					bool isObject = levels.back().isObject;
+					c = rd.nextWs();
+					rd.commit();
+					if (c == ',') {
+						if (isObject) parseKey();
+						break;
+					}
+					if (c != (isObject ? '}' : ']'))
+						throw ParseError(isObject ? "Expected ',' or '}'" : "Expected ',' or ']'");
+					v = finishLevel();
 				}
 			}
-			catch (ParseError &e) {
+		}
+		catch (ParseError &e) {
+			if (levels.size() > base) {
+				addContext(e, base);
+				const Level &l = levels[base];
+				tmpArr.resize(l.arrPos);
+				tmpKeyOffs.resize(l.keyPos);
+				tmpKeys.resize(l.keysLen);
+				levels.resize(base);
+			}
+			throw;
+		}
+	}
+
+	template<typename Fn>
+	inline void Parser<Fn>::parseKey()
+	{
+		if (rd.nextWs() != '"')
+			throw ParseError("Expected a key (string)");
+		rd.commit();
+		//key is stored separately, the object is created without the proxies
+		const std::string &name = readTmpString();
+		tmpKeyOffs.push_back(tmpKeys.length());
+		tmpKeys.append(name);
+		if (rd.nextWs() != ':')
+			throw ParseError("Expected ':'");
+		rd.commit();
+	}
+
+	template<typename Fn>
+	inline void Parser<Fn>::pushLevel(bool isObject)
+	{
+		if (levels.size() >= maxNestingDepth)
+			throw ParseError("Too deep nesting");
+		levels.push_back(Level{isObject, tmpArr.size(), tmpKeyOffs.size(), tmpKeys.length()});
+	}
+
+	template<typename Fn>
+	inline Value Parser<Fn>::finishLevel()
+	{
+		Level l = levels.back();
+		levels.pop_back();
+		if (l.isObject) return finishObject(l.arrPos, l.keyPos, l.keysLen);
+		return finishArray(l.arrPos);
+	}
+
+	template<typename Fn>
+	inline void Parser<Fn>::addContext(ParseError &e, std::size_t base) const
+	{
+		//the innermost container is added first
+		for (std::size_t j = levels.size(); j > base; --j) {
+			const Level &l = levels[j - 1];
+			bool inner = j < levels.size();
+			std::size_t keyEnd = inner ? levels[j].keyPos : tmpKeyOffs.size();
+			if (l.isObject) {
+				if (keyEnd > l.keyPos) {
+					std::size_t b = tmpKeyOffs[keyEnd - 1];
+					std::size_t ke = inner ? levels[j].keysLen : tmpKeys.length();
+					e.addContext(tmpKeys.substr(b, ke - b));
+				}
+			} else {
+				std::size_t arrEnd = inner ? levels[j].arrPos : tmpArr.size();
 				std::ostringstream buff;
-				buff << "[" << (tmpArr.size()-tmpArrPos) << "]";
+				buff << "[" << (arrEnd - l.arrPos) << "]";
 				e.addContext(buff.str());
-				throw;
 			}
-		} while (cont);
+		}
+	}
+
+	template<typename Fn>
+	inline Value Parser<Fn>::finishObject(std::size_t arrPos, std::size_t keyPos, std::size_t keysLen)
+	{
+		StringView<Value> data = tmpArr;
+		tmpKeyViews.clear();
+		for (std::size_t i = keyPos; i < tmpKeyOffs.size(); i++) {
+			std::size_t e = i + 1 < tmpKeyOffs.size() ? tmpKeyOffs[i + 1] : tmpKeys.length();
+			tmpKeyViews.push_back(StringView<char>(tmpKeys.data() + tmpKeyOffs[i], e - tmpKeyOffs[i]));
+		}
+		Value res(CompactObjectValue::create(tmpKeyViews, data.substr(arrPos), &keySets));
+		tmpArr.resize(arrPos);
+		tmpKeyOffs.resize(keyPos);
+		tmpKeys.resize(keysLen);
+		return res;
+	}
+
+	template<typename Fn>
+	inline Value Parser<Fn>::finishArray(std::size_t arrPos)
+	{
 		StringView<Value> arrView(tmpArr);
-		Value res(arrView.substr(tmpArrPos));
-		tmpArr.resize(tmpArrPos);
+		Value res(arrView.substr(arrPos));
+		tmpArr.resize(arrPos);
 		return res;
-		
 	}
 
 	template<typename Fn>
@@ -418,6 +823,18 @@ namespace json {
 
 	template<typename Fn>
 	inline Value Parser<Fn>::parseNumber()
+	{
+		NumberToken n;
+		readNumber(n);
+		switch (n.kind) {
+			case numberUnsignedInteger: return Value(n.u);
+			case numberInteger: return Value(n.i);
+			default: return Value(n.d);
+		}
+	}
+
+	template<typename Fn>
+	inline void Parser<Fn>::readNumber(NumberToken &n)
 	{		
 		//first try to read number as signed or unsigned integer
 		std::uintptr_t intpart;
@@ -436,7 +853,9 @@ namespace json {
 		//in case of overflow or dot follows, continue to read as floating number
 		if (!complete || rd.next() == '.' || toupper(rd.next()) == 'E') {
 			//parse floating number (give it already parsed informations)
-			return parseDouble(intpart, isneg);
+			n.kind = 0;
+			n.d = readDouble(intpart, isneg);
+			return;
 		}
 		//is negative?
 		if (isneg) {
@@ -445,21 +864,21 @@ namespace json {
 			if (intpart & (std::uintptr_t(1) << (sizeof(intpart) * 8 - 1))) {
 				//convert number to float
 				double v = (double)intpart;
-				//return negative value
-				return Value(-v);
+				//store negative value
+				n.kind = 0;
+				n.d = -v;
 			}
 			else {
-				//convert to signed and return negative
-				return Value(-intptr_t(intpart));
+				//convert to signed and store negative
+				n.kind = numberInteger;
+				n.i = -intptr_t(intpart);
 			}
 		}
 		else {
-			//return unsigned version
-			return Value(intpart);
+			//store unsigned version
+			n.kind = numberUnsignedInteger;
+			n.u = intpart;
 		}
-
-
-
 	}
 
 	template<typename Fn>
@@ -471,8 +890,15 @@ namespace json {
 
 	template<typename Fn>
 	inline std::string Parser<Fn>::readString()
+	{
+		return readTmpString();
+	}
+
+	template<typename Fn>
+	inline const std::string &Parser<Fn>::readTmpString()
 	{
 		tmpstr.clear();
+		rd.readPlainRun(tmpstr);
 		char c = rd.nextCommit();
 		while (c != '"') {
 			if (c == -1)
@@ -502,6 +928,8 @@ namespace json {
 				tmpstr.push_back(c);
 				//read next
 			}
+			//copy characters up to next special character
+			rd.readPlainRun(tmpstr);
 			c = rd.nextCommit();
 
 	
@@ -557,112 +985,52 @@ namespace json {
 	}
 
 	template<typename Fn>
-	inline double Parser<Fn>::parseLargeUnsigned(uintptr_t intPart)
+	inline Value Parser<Fn>::parseDouble(uintptr_t intpart, bool neg)
 	{
-		//starts with given integer part - convert to double
-		double res = (double)intPart;
-		//read while there are digits
-		while (isdigit(rd.next())) {
-			//prepare next unsigned integer
-			uintptr_t part;
-			//prepare counter
-			int cnt;
-			//read next sequence of digits as integer
-			parseUnsigned(part, cnt);
-			//now res = res * 10^cnt + part 
-			//this should reduce rounding errors because count of multiplies will be minimal
-			res = res * pow(10.0, cnt) + double(part);
-
-			if (std::isinf(res)) throw ParseError("Too long number");
-		}
-		//return the result
-		return res;
+		return Value(readDouble(intpart, neg));
 	}
 
 	template<typename Fn>
-	inline double Parser<Fn>::parseDecimalPart()
-	{
-		//parses decimal part as series of unsigned number each is multipled by its position
-		double res = 0;
-		//current position
-		int curpos = 0;
-		//read while there all digites
-		while (isdigit(rd.next())) {
-			//prepare integer part
-			uintptr_t part;
-			//prepare counter
-			int cnt;
-			//read sequence of digiths as integer
-			parseUnsigned(part, cnt);
-			//update position of this part
-			curpos += cnt;
-			//combine part with result
-			res = res + (double(part) * pow(0.1, curpos));
-		}
-		//there goes result
-		return res;
-	}
-
-	template<typename Fn>
-	inline Value Parser<Fn>::parseDouble(uintptr_t intpart, bool neg)
+	inline double Parser<Fn>::readDouble(uintptr_t intpart, bool neg)
 	{
 		//float number is in format [+/-]digits[.digits][E[+/-]digits]
 		//sign is stored in neg
+		//the text of the number is collected and converted at once, so the
+		//result is correctly rounded
+		char buff[formatIntBufferSize];
+		tmpnum.assign(buff, formatUnsigned(intpart, buff));
 		//complete to reading integer part
-		double d = parseLargeUnsigned(intpart);
+		rd.readDigits(tmpnum);
 		//if next char is dot
 		if (rd.next() == '.') {
 			//commit dot
 			rd.commit();
 			//next character must be a digit
-			if (isdigit(rd.next())) {
-				//so parse decimal part
-				double frac = parseDecimalPart();
-				//combine with integer part
-				d = d + frac;
-			}
-			else {
+			if (!isdigit(rd.next())) {
 				//throw exception that next character is not digit
 				throw ParseError("Expected '0'...'9' after '.'");
 			}
+			tmpnum.push_back('.');
+			//so read decimal part
+			rd.readDigits(tmpnum);
 		}
 		//next character is 'E' (exponent part)
 		if (toupper(rd.next()) == 'E') {
 			//commit the 'E'
 			rd.commit();
-			//read and discard any possible sign
-			bool negexp = readSign();
-			//prepare integer exponent
-			uintptr_t expn;
-			//prepare counter (we don't need it)
-			int counter;
+			tmpnum.push_back('e');
+			//read sign of the exponent
+			if (readSign()) tmpnum.push_back('-');
 			//next character must be a digit
 			if (!isdigit(rd.next()))
 				//throw exception is doesn't it
 				throw ParseError("Expected '0'...'9' after 'E'");
-			//parse the exponent
-			if (!parseUnsigned(expn, counter))
-				//complain about too large exponent (two or three digits must match to uintptr_t)
-				throw ParseError("Exponent is too large");
-			//if exponent is negative
-			if (negexp) {
-				//calculate d * 0.1^expn
-				d = d * pow(0.1, expn);
-			}
-			else {
-				//calculate d * 10^expn
-				d = d * pow(10.0, expn);
-			}			
-		}
-		//negative value
-		if (neg) {
-			//return negative
-			return Value(-d);
-		} 
-		else {
-			//return positive
-			return Value(d);
+			//read the exponent
+			rd.readDigits(tmpnum);
 		}
+		double d = decimalToDouble(tmpnum.data(), tmpnum.length());
+		if (std::isinf(d)) throw ParseError("Too long number");
+		return neg ? -d : d;
 	}
 
 }
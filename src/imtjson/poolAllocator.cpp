@@ -0,0 +1,271 @@
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include "poolAllocator.h"
+#include "chunkOwner.h"
+#include "parseArena.h"
+
+namespace json {
+
+	///Classes up to this size grow by 16 bytes
+	static const std::size_t smallLimit = 256;
+	static const unsigned int smallClasses = 16;
+	///Classes above the smallLimit grow by 64 bytes up to this size
+	static const std::size_t maxPoolBlock = 1024;
+	static const unsigned int classCount = smallClasses + (maxPoolBlock - smallLimit) / 64;
+
+	static unsigned int sizeClass(std::size_t sz) {
+		if (sz <= smallLimit) return sz ? (unsigned int)((sz - 1) >> 4) : 0;
+		return smallClasses + (unsigned int)((sz - smallLimit - 1) >> 6);
+	}
+
+	static std::size_t classSize(unsigned int cls) {
+		if (cls < smallClasses) return std::size_t(cls + 1) << 4;
+		return smallLimit + (std::size_t(cls - smallClasses + 1) << 6);
+	}
+
+	///Free block - the memory of the block is used as the link to the next block
+	struct FreeBlock {
+		FreeBlock *next;
+	};
+
+	///Batch of free blocks in the shared pool - the first block also links the next batch
+	/** The smallest block has 16 bytes, so both links fit into it. The link to the next
+	 * batch is atomic, because a thread which lost the race in the pop can still read it */
+	struct FreeBatch {
+		FreeBlock block;
+		std::atomic<FreeBatch *> nextBatch;
+	};
+
+	///Pool of the blocks of the one size class shared by all threads
+	/** The pool is a lock-free stack of batches. The head contains a tag which is changed
+	 * by every update, so the pop can't succeed with a batch which has been popped and
+	 * pushed back meanwhile (ABA problem). Chunks are registered only below 48 bits
+	 * of the address space, so the remaining 16 bits of the head are used for the tag */
+	class PoolClass : public ChunkOwner {
+	public:
+		PoolClass() :head(0) {}
+
+		void init(unsigned int cls) {
+			index = cls;
+			blockSize = classSize(cls);
+			std::size_t b = 16384 / blockSize;
+			batchSize = (unsigned int)(b < 8 ? 8 : b > 64 ? 64 : b);
+		}
+
+		///Takes a batch of blocks from the pool
+		/**
+		 * @param taken receives count of blocks in the batch
+		 * @return linked list of blocks (nullptr if memory is exhausted)
+		 */
+		FreeBlock *take(unsigned int &taken) {
+			FreeBatch *b = pop();
+			if (b == nullptr) b = newChunk();
+			if (b == nullptr) return nullptr;
+			FreeBlock *first = &b->block;
+			taken = 0;
+			for (FreeBlock *x = first; x; x = x->next) taken++;
+			return first;
+		}
+
+		///Puts linked list of blocks to the pool as one batch
+		/** @param first first block of the list terminated by nullptr */
+		void give(FreeBlock *first) {
+			FreeBatch *b = reinterpret_cast<FreeBatch *>(first);
+			push(b, b);
+		}
+
+		unsigned int getIndex() const { return index; }
+		unsigned int getBatchSize() const { return batchSize; }
+
+	protected:
+		static const unsigned int tagShift = 48;
+		static const std::uint64_t ptrMask = (std::uint64_t(1) << tagShift) - 1;
+
+		std::atomic<std::uint64_t> head;
+		std::size_t blockSize;
+		unsigned int index;
+		unsigned int batchSize;
+
+		static FreeBatch *headPtr(std::uint64_t h) {
+			return reinterpret_cast<FreeBatch *>(static_cast<std::uintptr_t>(h & ptrMask));
+		}
+		static std::uint64_t nextHead(std::uint64_t h, FreeBatch *b) {
+			return (((h >> tagShift) + 1) << tagShift) | reinterpret_cast<std::uintptr_t>(b);
+		}
+
+		FreeBatch *pop() {
+			std::uint64_t h = head.load(std::memory_order_acquire);
+			FreeBatch *b;
+			while ((b = headPtr(h)) != nullptr) {
+				FreeBatch *n = b->nextBatch.load(std::memory_order_relaxed);
+				if (head.compare_exchange_weak(h, nextHead(h, n),
+						std::memory_order_acquire, std::memory_order_acquire)) break;
+			}
+			return b;
+		}
+
+		///Pushes chain of batches linked through nextBatch
+		void push(FreeBatch *first, FreeBatch *last) {
+			std::uint64_t h = head.load(std::memory_order_relaxed);
+			do {
+				last->nextBatch.store(headPtr(h), std::memory_order_relaxed);
+			} while (!head.compare_exchange_weak(h, nextHead(h, first),
+					std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		///Splits new chunk to batches
+		/** @return first batch, other batches are pushed to the pool */
+		FreeBatch *newChunk() {
+			char *c = allocChunk();
+			if (c == nullptr) return nullptr;
+			std::size_t count = chunkSize / blockSize;
+			FreeBatch *first = nullptr;
+			FreeBatch *prev = nullptr;
+			for (std::size_t i = 0; i < count; i += batchSize) {
+				std::size_t end = i + batchSize < count ? i + batchSize : count;
+				FreeBatch *b = reinterpret_cast<FreeBatch *>(c + i * blockSize);
+				for (std::size_t j = i; j < end; j++) {
+					FreeBlock *x = reinterpret_cast<FreeBlock *>(c + j * blockSize);
+					x->next = j + 1 < end ? reinterpret_cast<FreeBlock *>(c + (j + 1) * blockSize) : nullptr;
+				}
+				new(&b->nextBatch) std::atomic<FreeBatch *>(nullptr);
+				if (prev) prev->nextBatch.store(b, std::memory_order_relaxed);
+				else first = b;
+				prev = b;
+			}
+			FreeBatch *rest = first->nextBatch.load(std::memory_order_relaxed);
+			if (rest) push(rest, prev);
+			return first;
+		}
+
+		virtual void deallocBlock(void *ptr) override;
+	};
+
+	///Shared pools are never destroyed, because values can be released during the exit as well
+	static PoolClass *createClasses() {
+		PoolClass *cls = new PoolClass[classCount];
+		for (unsigned int i = 0; i < classCount; i++) cls[i].init(i);
+		return cls;
+	}
+
+	static PoolClass &getClass(unsigned int cls) {
+		static PoolClass *classes = createClasses();
+		return classes[cls];
+	}
+
+	///Free blocks owned by the thread
+	/** Trivially destructible, so it is still accessible while other thread local
+	 * variables are being destroyed */
+	struct ThreadCache {
+		enum State {
+			///cache is not used yet
+			inactive,
+			///cache is used, it will be flushed when the thread exits
+			active,
+			///thread is finishing, blocks are passed directly to the shared pool
+			finished
+		};
+
+		FreeBlock *lists[classCount];
+		unsigned int counts[classCount];
+		State state;
+	};
+
+	static thread_local ThreadCache threadCache;
+
+	static void flushThreadCache() {
+		ThreadCache &tc = threadCache;
+		for (unsigned int i = 0; i < classCount; i++) {
+			FreeBlock *first = tc.lists[i];
+			if (first == nullptr) continue;
+			getClass(i).give(first);
+			tc.lists[i] = nullptr;
+			tc.counts[i] = 0;
+		}
+	}
+
+	class ThreadCacheGuard {
+	public:
+		~ThreadCacheGuard() {
+			flushThreadCache();
+			threadCache.state = ThreadCache::finished;
+		}
+	};
+
+	///Registers the flush of the cache at the exit of the thread
+	/** @retval true cache can be used
+	 *  @retval false thread is finishing, cache cannot be used */
+	static bool activateThreadCache() {
+		ThreadCache &tc = threadCache;
+		if (tc.state == ThreadCache::finished) return false;
+		static thread_local ThreadCacheGuard guard;
+		(void)guard;
+		tc.state = ThreadCache::active;
+		return true;
+	}
+
+	static void *refill(unsigned int cls) {
+		ThreadCache &tc = threadCache;
+		PoolClass &pool = getClass(cls);
+		unsigned int taken;
+		FreeBlock *first = pool.take(taken);
+		if (first == nullptr) throw std::bad_alloc();
+		if (activateThreadCache()) {
+			tc.lists[cls] = first->next;
+			tc.counts[cls] = taken - 1;
+		} else if (first->next) {
+			//thread is finishing, its cache cannot hold the rest of the batch
+			pool.give(first->next);
+		}
+		return first;
+	}
+
+	void PoolClass::deallocBlock(void *ptr) {
+		ThreadCache &tc = threadCache;
+		FreeBlock *b = reinterpret_cast<FreeBlock *>(ptr);
+		if (tc.state != ThreadCache::active && !activateThreadCache()) {
+			b->next = nullptr;
+			give(b);
+			return;
+		}
+		b->next = tc.lists[index];
+		tc.lists[index] = b;
+		if (++tc.counts[index] > 2 * batchSize) {
+			//move one batch to the shared pool, so other threads can use it
+			FreeBlock *last = b;
+			for (unsigned int i = 1; i < batchSize; i++) last = last->next;
+			tc.lists[index] = last->next;
+			tc.counts[index] -= batchSize;
+			last->next = nullptr;
+			give(b);
+		}
+	}
+
+	static void *poolAlloc(std::size_t sz) {
+		void *p = ParseArena::allocCurrent(sz);
+		if (p) return p;
+		if (sz > maxPoolBlock) return ::operator new(sz);
+		unsigned int cls = sizeClass(sz);
+		ThreadCache &tc = threadCache;
+		FreeBlock *b = tc.lists[cls];
+		if (b == nullptr) return refill(cls);
+		tc.lists[cls] = b->next;
+		tc.counts[cls]--;
+		return b;
+	}
+
+	static void poolDealloc(void *ptr) {
+		if (!ChunkOwner::deallocOwned(ptr)) ::operator delete(ptr);
+	}
+
+	static Allocator poolAllocator = {
+		&poolAlloc,
+		&poolDealloc
+	};
+
+	const Allocator *getPoolAllocator() {
+		return &poolAllocator;
+	}
+
+}
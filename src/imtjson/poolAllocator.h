@@ -0,0 +1,34 @@
+#pragma once
+
+#include "ivalue.h"
+
+namespace json {
+
+	///Returns allocator which keeps the memory of the values in the per-thread pools
+	/** The allocator splits the values by their size into size classes. Each thread has own
+	 * list of free blocks for each class, so allocation and deallocation doesn't need any lock
+	 * nor atomic operation. The thread gets and returns the blocks in batches
+	 * from/to shared pool of the class, which is a lock-free stack of the batches.
+	 *
+	 * Blocks can be deallocated by any thread. The block is returned to the pool of the thread
+	 * which deallocates it, and if this thread collects too many free blocks, they are moved
+	 * to the shared pool, where other threads can pick them up. Free blocks of a finishing thread
+	 * are also moved to the shared pool.
+	 *
+	 * To use the allocator, install it at the beginning of the program
+	 *
+	 * @code
+	 * Value::allocator = getPoolAllocator();
+	 * @endcode
+	 *
+	 * The allocator can be installed and uninstalled at any time. Blocks of the pool are
+	 * recognized by their address, so they are correctly returned to the pool even if they
+	 * are deallocated when the default allocator is installed.
+	 *
+	 * @note Values larger than 1KB are allocated by the standard way. Memory of the pool is
+	 * never returned to the system, it is only reused for other values. If there is
+	 * a ParseArena installed for the current thread, the values are allocated from the arena.
+	 */
+	const Allocator *getPoolAllocator();
+
+}
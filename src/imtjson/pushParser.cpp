@@ -0,0 +1,279 @@
+#include "pushParser.h"
+#include "charScan.h"
+
+namespace json {
+
+	namespace {
+
+		///Characters which can appear in a number
+		bool isNumberChar(char c) {
+			return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+		}
+
+		///Value of the hexadecimal digit, -1 if the character is not a digit
+		int hexDigit(char c) {
+			if (c >= '0' && c <= '9') return c - '0';
+			if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+			if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+			return -1;
+		}
+
+	}
+
+	PushParser::PushParser()
+		:Parser<BufferSource>(BufferSource(nullptr, 0))
+		,state(stValue),stringIsKey(false),uchar(0),remain(0),keywordPos(0),offset(0)
+	{
+	}
+
+	void PushParser::feed(const char *data, std::size_t length) {
+		const char *p = data;
+		const char *end = data + length;
+		try {
+			while (p != end) {
+				switch (state) {
+				case stValue:
+				case stFirstItem:
+					p = skipWhitespace(p, end);
+					if (p == end) break;
+					if (state == stFirstItem && *p == ']') {
+						++p;
+						completeValue(finishLevel());
+					} else if (startValue(*p)) {
+						++p;
+					}
+					break;
+				case stFirstKey:
+				case stKey:
+					p = skipWhitespace(p, end);
+					if (p == end) break;
+					if (*p == '"') {
+						++p;
+						startString(true);
+					} else if (state == stFirstKey && *p == '}') {
+						++p;
+						completeValue(finishLevel());
+					} else {
+						throw ParseError("Expected a key (string)");
+					}
+					break;
+				case stColon:
+					p = skipWhitespace(p, end);
+					if (p == end) break;
+					if (*p != ':') throw ParseError("Expected ':'");
+					++p;
+					state = stValue;
+					break;
+				case stNext: {
+					p = skipWhitespace(p, end);
+					if (p == end) break;
+					bool isObject = levels.back().isObject;
+					if (*p == ',') {
+						++p;
+						state = isObject ? stKey : stValue;
+					} else if (*p == (isObject ? '}' : ']')) {
+						++p;
+						completeValue(finishLevel());
+					} else {
+						throw ParseError(isObject ? "Expected ',' or '}'" : "Expected ',' or ']'");
+					}
+					break;
+				}
+				case stString: {
+					//plain characters are copied in bulk
+					const char *q = findStringSpecial(p, end);
+					tmpstr.append(p, q);
+					p = q;
+					if (p != end) {
+						stringSpecial(*p);
+						++p;
+					}
+					break;
+				}
+				case stEscape:
+					escapeChar(*p);
+					++p;
+					break;
+				case stUnicode: {
+					int d = hexDigit(*p);
+					if (d < 0)
+						throw ParseError("Expected '0'...'9' or 'A'...'F' after the escape sequence \\u: (" + tmpstr + ")");
+					++p;
+					uchar = uchar * 16 + d;
+					if (--remain == 0) {
+						storeUnicode(uchar);
+						state = stString;
+					}
+					break;
+				}
+				case stUtf8:
+					if ((*p & 0x80) == 0)
+						throw ParseError("Invalid UTF-8 sequence - expected byte in range 0x80...0xFF (" + tmpstr + ")");
+					--remain;
+					uchar |= std::uintptr_t(*p & 0x3F) << (6 * remain);
+					++p;
+					if (remain == 0) {
+						storeUnicode(uchar);
+						state = stString;
+					}
+					break;
+				case stNumber: {
+					const char *q = p;
+					while (q != end && isNumberChar(*q)) ++q;
+					numText.append(p, q);
+					p = q;
+					//the number can continue in the next part
+					if (p != end) finishNumber();
+					break;
+				}
+				case stKeyword:
+					if (*p != keyword.data[keywordPos]) throw ParseError("Unknown keyword");
+					++p;
+					if (++keywordPos == keyword.length) {
+						switch (keyword.data[0]) {
+						case 't': completeValue(Value(true)); break;
+						case 'f': completeValue(Value(false)); break;
+						default: completeValue(Value(nullptr)); break;
+						}
+					}
+					break;
+				}
+			}
+		}
+		catch (...) {
+			offset += p - data;
+			throw;
+		}
+		offset += length;
+	}
+
+	void PushParser::finish() {
+		if (state == stNumber) finishNumber();
+		if (!idle()) throw ParseError("Unexpected end of file");
+	}
+
+	bool PushParser::read(Value &out) {
+		if (results.empty()) return false;
+		out = results.front();
+		results.pop_front();
+		return true;
+	}
+
+	void PushParser::reset() {
+		state = stValue;
+		levels.clear();
+		results.clear();
+		tmpArr.clear();
+		tmpKeys.clear();
+		tmpKeyOffs.clear();
+		offset = 0;
+	}
+
+	bool PushParser::startValue(char c) {
+		switch (c) {
+		case '{':
+			pushLevel(true);
+			state = stFirstKey;
+			return true;
+		case '[':
+			pushLevel(false);
+			state = stFirstItem;
+			return true;
+		case '"':
+			startString(false);
+			return true;
+		case 't': keyword = "true"; break;
+		case 'f': keyword = "false"; break;
+		case 'n': keyword = "null"; break;
+		default:
+			if (!isNumberChar(c)) throw ParseError("Expected '0'...'9', '.', '+' or '-'");
+			numText.clear();
+			state = stNumber;
+			return false;
+		}
+		keywordPos = 1;
+		state = stKeyword;
+		return true;
+	}
+
+	void PushParser::startString(bool key) {
+		tmpstr.clear();
+		stringIsKey = key;
+		state = stString;
+	}
+
+	void PushParser::stringSpecial(char c) {
+		if (c == '"') {
+			if (stringIsKey) {
+				tmpKeyOffs.push_back(tmpKeys.length());
+				tmpKeys.append(tmpstr);
+				state = stColon;
+			} else {
+				completeValue(Value(tmpstr));
+			}
+		} else if (c == '\\') {
+			state = stEscape;
+		} else if (c & 0x80) {
+			//same checks as Parser::parseUtf8()
+			if ((c & 0xE0) == 0xC0) {
+				uchar = std::uintptr_t(c & 0x3F) << 6;
+				remain = 1;
+			} else if ((c & 0xF0) == 0xE0) {
+				uchar = std::uintptr_t(c & 0x1F) << 12;
+				remain = 2;
+			} else if ((c & 0xF8) == 0xF0) {
+				uchar = std::uintptr_t(c & 0x0F) << 18;
+				remain = 3;
+			} else {
+				throw ParseError("Invalid UTF-8 sequence - unsupported initial byte of the sequence (" + tmpstr + ")");
+			}
+			state = stUtf8;
+		} else {
+			tmpstr.push_back(c);
+		}
+	}
+
+	void PushParser::escapeChar(char c) {
+		state = stString;
+		switch (c) {
+		case '"':
+		case '\\':
+		case '/': tmpstr.push_back(c); break;
+		case 'b': tmpstr.push_back('\b'); break;
+		case 'f': tmpstr.push_back('\f'); break;
+		case 'n': tmpstr.push_back('\n'); break;
+		case 'r': tmpstr.push_back('\r'); break;
+		case 't': tmpstr.push_back('\t'); break;
+		case 'u':
+			uchar = 0;
+			remain = 4;
+			state = stUnicode;
+			break;
+		default: throw ParseError("Unexpected escape sequence in the string");
+		}
+	}
+
+	void PushParser::finishNumber() {
+		//the complete text of the number is converted by the Parser
+		rd = Reader(BufferSource(numText));
+		NumberToken n;
+		readNumber(n);
+		if (rd.consumed() != numText.length()) throw ParseError("Invalid number");
+		switch (n.kind) {
+		case numberUnsignedInteger: completeValue(Value(n.u)); break;
+		case numberInteger: completeValue(Value(n.i)); break;
+		default: completeValue(Value(n.d)); break;
+		}
+	}
+
+	void PushParser::completeValue(const Value &v) {
+		if (levels.empty()) {
+			results.push_back(v);
+			state = stValue;
+		} else {
+			tmpArr.push_back(v);
+			state = stNext;
+		}
+	}
+
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include "parser.h"
+
+namespace json {
+
+	///Parser which receives the text in parts as they arrive
+	/** The Parser pulls characters from the source and blocks when the source has no data.
+	The PushParser is driven by the caller instead: each part of the text is passed to the
+	function feed(), which processes it whole and returns. The state of the parsing (open
+	containers, unfinished string, number or keyword) is stored inside of the object, so the
+	text can be split at any byte, even inside of an escape sequence or an UTF-8 sequence.
+	The containers are tracked by an explicit stack, the nesting doesn't consume the native
+	stack.
+
+	The text can contain more values separated by optional whitespaces (for example NDJSON).
+	Completed values are queued and they are retrieved by the function read(). A number at
+	the top level is complete when it is followed by a character, which is not part of the
+	number, or when finish() is called.
+
+	Strings and numbers are decoded by the same rules as the Parser, so the result is
+	the same.
+
+	@code
+	PushParser parser;
+	while (socket has data) {
+		parser.feed(buffer, received);
+		Value v;
+		while (parser.read(v)) {
+			...
+		}
+	}
+	parser.finish();
+	@endcode
+
+	@note After the ParseError, the parser must be reset() before it is used again
+	*/
+	class PushParser : protected Parser<BufferSource> {
+	public:
+		PushParser();
+
+		///Processes next part of the text
+		/**
+		@param data pointer to the text
+		@param length length of the text
+		@exception ParseError parsing error. Values completed before the error are available
+		*/
+		void feed(const char *data, std::size_t length);
+		///Processes next part of the text
+		void feed(const StringView<char> &data) { feed(data.data, data.length); }
+		///Signals end of the text
+		/** Completes the number at the end of the text
+		@exception ParseError the text ends inside of a value
+		*/
+		void finish();
+
+		///Retrieves next completed value
+		/**
+		@param out variable which receives the value
+		@retval true value retrieved
+		@retval false no completed value is available
+		*/
+		bool read(Value &out);
+		///Retrieves count of completed values which were not retrieved yet
+		std::size_t available() const { return results.size(); }
+		///Returns true, when the parser is not inside of a value
+		bool idle() const { return state == stValue && levels.empty(); }
+		///Retrieves count of bytes processed since the construction or the last reset()
+		/** When ParseError is thrown, it is the offset of the invalid character */
+		std::size_t consumed() const { return offset; }
+
+		///Discards the state and all completed values, the parser can be used for a new text
+		void reset();
+
+	protected:
+		enum State {
+			///value is expected
+			stValue,
+			///value or ']' is expected
+			stFirstItem,
+			///key or '}' is expected
+			stFirstKey,
+			///key is expected
+			stKey,
+			///':' is expected
+			stColon,
+			///',' or the closing bracket is expected
+			stNext,
+			///inside of a string
+			stString,
+			///after the backslash inside of a string
+			stEscape,
+			///inside of the \\uXXXX sequence
+			stUnicode,
+			///inside of an UTF-8 sequence
+			stUtf8,
+			///inside of a number
+			stNumber,
+			///inside of a keyword
+			stKeyword
+		};
+
+		State state;
+		///completed top-level values
+		std::deque<Value> results;
+		///true if the string being parsed is a key
+		bool stringIsKey;
+		///code of the unfinished \\uXXXX or UTF-8 sequence
+		std::uintptr_t uchar;
+		///count of remaining characters of the \\uXXXX or UTF-8 sequence
+		unsigned int remain;
+		///keyword being parsed and count of its matched characters
+		StringView<char> keyword;
+		std::size_t keywordPos;
+		///text of the number being parsed (tmpnum is used during the conversion)
+		std::string numText;
+		///processed bytes
+		std::size_t offset;
+
+		///Starts parsing of a value at the character c
+		/** @retval true character has been consumed
+		@retval false character is the first character of a number, it was not consumed */
+		bool startValue(char c);
+		///Starts parsing of a string (the quote has been consumed)
+		void startString(bool key);
+		///Processes character of the string which needs special processing
+		void stringSpecial(char c);
+		///Processes character after the backslash
+		void escapeChar(char c);
+		///Converts the text of the number to the value
+		void finishNumber();
+		///Stores completed value to the container or to the results
+		void completeValue(const Value &v);
+	};
+
+}
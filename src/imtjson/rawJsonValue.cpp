@@ -0,0 +1,75 @@
+#include "rawJsonValue.h"
+#include "charScan.h"
+#include "jsonTape.h"
+#include "parser.h"
+#include "value.h"
+
+namespace json {
+
+	namespace {
+
+		ValueType typeOfJson(char c) {
+			switch (c) {
+			case '{': return object;
+			case '[': return array;
+			case '"': return string;
+			case 't':
+			case 'f': return boolean;
+			case 'n': return null;
+			default: return number;
+			}
+		}
+
+	}
+
+	bool RawJsonValue::isValidJson(const StringView<char> &text) {
+		return JsonTape::validate(text);
+	}
+
+	Value RawJsonValue::create(const String &text, bool validate) {
+		StringView<char> str = text;
+		if (validate && !isValidJson(str)) throw ParseError("Invalid JSON text");
+		const char *end = str.data + str.length;
+		const char *b = skipWhitespace(str.data, end);
+		const char *e = end;
+		while (e != b && isJsonWhitespace(e[-1])) --e;
+		if (b == e) throw ParseError("Unexpected end of file");
+		return PValue(new RawJsonValue(text, StringView<char>(b, e - b)));
+	}
+
+	RawJsonValue::RawJsonValue(const String &text, const StringView<char> &json)
+		:text(text),json(json),vtype(typeOfJson(json[0])),parsedValue(nullptr)
+	{
+	}
+
+	RawJsonValue::~RawJsonValue() {
+		const IValue *x = parsedValue.load(std::memory_order_acquire);
+		if (x && x->release()) delete x;
+	}
+
+	ValueTypeFlags RawJsonValue::flags() const {
+		//flags of numbers tell how the number is stored
+		if (vtype == number) return userDefined | parsed()->flags();
+		//string parsed from the shared text is not terminated, String must copy it
+		if (vtype == string) return userDefined | (parsed()->flags() & unterminatedString);
+		return userDefined;
+	}
+
+	Value RawJsonValue::parseJson() const {
+		//the parsed strings can refer the text, if there are no surrounding whitespaces
+		return json.length == text.length() ? Value::fromSharedString(text) : Value::fromString(json);
+	}
+
+	const IValue *RawJsonValue::parsed() const {
+		const IValue *x = parsedValue.load(std::memory_order_acquire);
+		if (x) return x;
+		PValue h = parseJson().getHandle();
+		const IValue *nx = h;
+		nx->addRef();
+		if (parsedValue.compare_exchange_strong(x, nx, std::memory_order_acq_rel)) return nx;
+		//other thread was faster
+		nx->release();
+		return x;
+	}
+
+}
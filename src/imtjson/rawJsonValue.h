@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include "abstractValue.h"
+#include "string.h"
+
+namespace json {
+
+	///Value which holds already serialized JSON
+	/** The text is written by the serializer without any change, so it can be used to embed
+	JSON received from other source into a new document without parsing and serializing it again.
+	The text is parsed on the first access to its content (size(), member(), getString(), etc).
+	The parsed value is kept with the object.
+
+	The serializer writes the text as it is regardless on the unicode format and the
+	current maxPrecisionDigits.
+
+	The value reports the flag userDefined. Its type is determined from the first character
+	of the text, so testing the type doesn't need to parse the text.
+	*/
+	class RawJsonValue : public AbstractValue {
+	public:
+		///Creates the value
+		/**
+		@param text JSON text. It must contain exactly one JSON value. Whitespaces around the
+		value are allowed, they are not part of the emitted text
+		@param validate true to check syntax of the text. Set false only for trusted text, because
+		invalid text produces invalid output
+		@return the value
+		@exception ParseError the text is not valid JSON
+		*/
+		static Value create(const String &text, bool validate = true);
+
+		///Checks syntax of the JSON text
+		/** The function doesn't allocate any value, it only scans the text
+		@param text text to check
+		@return true if the text contains exactly one valid JSON value (with optional whitespaces)
+		*/
+		static bool isValidJson(const StringView<char> &text);
+
+		~RawJsonValue();
+
+		virtual ValueType type() const override { return vtype; }
+		virtual ValueTypeFlags flags() const override;
+
+		virtual std::uintptr_t getUInt() const override { return parsed()->getUInt(); }
+		virtual std::intptr_t getInt() const override { return parsed()->getInt(); }
+		virtual double getNumber() const override { return parsed()->getNumber(); }
+		virtual bool getBool() const override { return parsed()->getBool(); }
+		virtual StringView<char> getString() const override { return parsed()->getString(); }
+		virtual std::size_t size() const override { return parsed()->size(); }
+		virtual const IValue *itemAtIndex(std::size_t index) const override { return parsed()->itemAtIndex(index); }
+		virtual const IValue *member(const StringView<char> &name) const override { return parsed()->member(name); }
+		virtual bool enumItems(const IEnumFn &fn) const override { return parsed()->enumItems(fn); }
+		virtual bool equal(const IValue *other) const override { return parsed()->equal(other->unproxy()); }
+		virtual const RawJsonValue *getRawJson() const override { return this; }
+
+		///Retrieves the JSON text (without surrounding whitespaces)
+		StringView<char> getJson() const { return json; }
+		///Retrieves parsed value. The text is parsed on the first call
+		const IValue *parsed() const;
+
+	protected:
+		RawJsonValue(const String &text, const StringView<char> &json);
+
+		///Parses the text, called once on the first access to the content
+		virtual Value parseJson() const;
+
+		///keeps the text
+		String text;
+		///JSON part of the text
+		StringView<char> json;
+		///type of the value
+		ValueType vtype;
+		///parsed value, created on the first access
+		mutable std::atomic<const IValue *> parsedValue;
+	};
+
+}
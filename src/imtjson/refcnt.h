@@ -1,27 +1,98 @@
 #pragma once
 
 #include <atomic>
+#ifdef IMTJSON_NONATOMIC_REFCNT
+#include <cstdlib>
+#include <thread>
+#endif
 
 namespace json {
 
+#ifdef IMTJSON_NONATOMIC_REFCNT
+
+	///Reference counter which is updated without atomic operations
+	/** It is used when the library is built with IMTJSON_NONATOMIC_REFCNT. In this mode,
+	 * each value must be used only by the thread which created it. This is checked when
+	 * IMTJSON_REFCNT_CHECK_THREAD is defined too (the CMake build defines it for the Debug
+	 * configuration), the counter then remembers the thread which took the first reference.
+	 * The access from an other thread calls abort().
+	 *
+	 * Both definitions change the layout of the objects, so the code which includes the headers
+	 * must be compiled with the same definitions as the library. The CMake target imtjson
+	 * exports them.
+	 *
+	 * @note The preallocated values (null, booleans, small numbers, etc) are immortal,
+	 * so they can be still used by all threads.
+	 */
+	class RefCounter {
+	public:
+		RefCounter(int v):v(v) {}
+
+		int load(std::memory_order) const noexcept {return v;}
+		void store(int x, std::memory_order) noexcept {v = x;}
+		int operator++() noexcept {checkThread(); return ++v;}
+		int operator--() noexcept {checkThread(); return --v;}
+
+	protected:
+		int v;
+#ifdef IMTJSON_REFCNT_CHECK_THREAD
+		std::thread::id owner;
+
+		void checkThread() noexcept {
+			std::thread::id cur = std::this_thread::get_id();
+			if (v == 0) owner = cur;
+			else if (owner != cur) abort();
+		}
+#else
+		void checkThread() noexcept {}
+#endif
+	};
+
+#else
+
+	typedef std::atomic_int RefCounter;
+
+#endif
+
 	///Simple refcounting 
-	/** Because std::shared_ptr is too heavy a bloated and slow and wastes a lot memory */
+	/** Because std::shared_ptr is too heavy a bloated and slow and wastes a lot memory
+	 *
+	 * The counter is atomic, unless the library is built with IMTJSON_NONATOMIC_REFCNT
+	 * (see RefCounter)
+	 */
 	class RefCntObj {
 	public:
 
 		void addRef() const noexcept {
+			if (isImmortal()) return;
 			++counter;
 		}
 
 		bool release() const noexcept {
+			if (isImmortal()) return false;
 			return --counter == 0;
 		}
 
 		RefCntObj():counter(0) {}
 
+		///Marks the object immortal
+		/** Immortal object is never destroyed and its reference counter is no longer updated,
+		 * so the object can be shared between many threads without contention on the counter.
+		 * It is intended for preallocated static values */
+		void setImmortal() const noexcept {
+			counter.store(immortalCounter, std::memory_order_relaxed);
+		}
+
+		bool isImmortal() const noexcept {
+			return counter.load(std::memory_order_relaxed) >= immortalCounter;
+		}
+
 
 	protected:
-		mutable std::atomic_int counter;
+		mutable RefCounter counter;
+
+		///Counters above this value are considered as immortal (they can't be reached by references)
+		static const int immortalCounter = 0x40000000;
 
 	};
 
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <vector>
+#include "parser.h"
+
+namespace json {
+
+	///Receives events of the SaxParser
+	/** The class defines all events with empty implementation. Inherit the class and define
+	only the events you need (the functions are not virtual, the handler is a template argument
+	of the parser).
+
+	Strings and keys are passed as StringView, which is valid only during the call
+	*/
+	class SaxHandler {
+	public:
+		void startObject() {}
+		void key(const StringView<char> &) {}
+		void endObject() {}
+		void startArray() {}
+		void endArray() {}
+		void string(const StringView<char> &) {}
+		///unsigned integer number
+		void unsignedInteger(std::uintptr_t) {}
+		///negative integer number
+		void integer(std::intptr_t) {}
+		///floating point number (also integer numbers which don't fit to the integer types)
+		void number(double) {}
+		void boolean(bool) {}
+		void null() {}
+	};
+
+	///Parser which reports the content of JSON to the handler without creating the values
+	/** The parser uses the same reader and the same functions to parse strings and numbers
+	as the Parser. It doesn't allocate any value, so it can be used to extract few fields,
+	to aggregate or to transcode large documents. Strings from a BufferSource are passed
+	directly from the buffer when they don't need to be decoded.
+
+	The nesting is tracked by an explicit stack, so deep documents don't consume the native stack
+
+	@code
+	struct SumHandler : SaxHandler {
+		double sum = 0;
+		void number(double v) {sum += v;}
+		void unsignedInteger(std::uintptr_t v) {sum += v;}
+		void integer(std::intptr_t v) {sum += v;}
+	};
+
+	SumHandler h;
+	SaxParser<BufferSource> parser(BufferSource(text));
+	parser.parseEvents(h);
+	@endcode
+	*/
+	template<typename Fn>
+	class SaxParser : public Parser<Fn> {
+	public:
+		SaxParser(const Fn &source) :Parser<Fn>(source) {}
+
+		///Parses one JSON value and reports its content to the handler
+		/**
+		@param handler object which receives the events (see SaxHandler)
+		@exception ParseError parsing error. Events before the error are already reported
+		*/
+		template<typename Handler>
+		void parseEvents(Handler &handler);
+
+	protected:
+		///closing characters of the open containers
+		std::vector<char> stack;
+
+		///Opens new container, checks the maxNestingDepth
+		void openContainer(char close) {
+			if (stack.size() >= maxNestingDepth) throw ParseError("Too deep nesting");
+			stack.push_back(close);
+		}
+		template<typename Handler>
+		void parseKey(Handler &handler);
+		template<typename Handler>
+		void parseStringEvent(Handler &handler, bool isKey);
+
+		template<typename R>
+		static bool readPlainString(R &, StringView<char> &) { return false; }
+		static bool readPlainString(ParserReader<BufferSource> &rd, StringView<char> &out) {
+			return rd.readPlainString(out);
+		}
+	};
+
+	template<typename Fn>
+	template<typename Handler>
+	inline void SaxParser<Fn>::parseEvents(Handler &handler)
+	{
+		typename Parser<Fn>::Reader &rd = this->rd;
+		stack.clear();
+		for (;;) {
+			//value expected
+			char c = rd.nextWs();
+			switch (c) {
+			case '{':
+				rd.commit();
+				handler.startObject();
+				if (rd.nextWs() == '}') {
+					rd.commit();
+					handler.endObject();
+					break;
+				}
+				openContainer('}');
+				parseKey(handler);
+				continue;
+			case '[':
+				rd.commit();
+				handler.startArray();
+				if (rd.nextWs() == ']') {
+					rd.commit();
+					handler.endArray();
+					break;
+				}
+				openContainer(']');
+				continue;
+			case '"':
+				rd.commit();
+				parseStringEvent(handler, false);
+				break;
+			case 't':
+				this->checkString("true");
+				handler.boolean(true);
+				break;
+			case 'f':
+				this->checkString("false");
+				handler.boolean(false);
+				break;
+			case 'n':
+				this->checkString("null");
+				handler.null();
+				break;
+			default: {
+				typename Parser<Fn>::NumberToken n;
+				this->readNumber(n);
+				switch (n.kind) {
+				case numberUnsignedInteger: handler.unsignedInteger(n.u); break;
+				case numberInteger: handler.integer(n.i); break;
+				default: handler.number(n.d); break;
+				}
+				break;
+			}
+			}
+			//value complete, close containers or continue to the next item
+			for (;;) {
+				if (stack.empty()) return;
+				char close = stack.back();
+				c = rd.nextWs();
+				rd.commit();
+				if (c == ',') {
+					if (close == '}') parseKey(handler);
+					break;
+				}
+				if (c != close)
+					throw ParseError(close == '}' ? "Expected ',' or '}'" : "Expected ',' or ']'");
+				stack.pop_back();
+				if (close == '}') handler.endObject();
+				else handler.endArray();
+			}
+		}
+	}
+
+	template<typename Fn>
+	template<typename Handler>
+	inline void SaxParser<Fn>::parseKey(Handler &handler)
+	{
+		typename Parser<Fn>::Reader &rd = this->rd;
+		if (rd.nextWs() != '"')
+			throw ParseError("Expected a key (string)");
+		rd.commit();
+		parseStringEvent(handler, true);
+		if (rd.nextWs() != ':')
+			throw ParseError("Expected ':'");
+		rd.commit();
+	}
+
+	template<typename Fn>
+	template<typename Handler>
+	inline void SaxParser<Fn>::parseStringEvent(Handler &handler, bool isKey)
+	{
+		StringView<char> str;
+		if (!readPlainString(this->rd, str)) str = this->readTmpString();
+		if (isKey) handler.key(str);
+		else handler.string(str);
+	}
+
+}
@@ -0,0 +1,41 @@
+#include "serializedCache.h"
+
+namespace json {
+
+	SerializedCache::SerializedCache():cache(nullptr) {
+	}
+
+	SerializedCache::~SerializedCache() {
+		Cache *c = cache.load(std::memory_order_relaxed);
+		if (c) {
+			for (auto &&e : c->entries) delete e.load(std::memory_order_relaxed);
+			delete c;
+		}
+	}
+
+	void SerializedCache::enableSerializedCache() const {
+		if (cache.load(std::memory_order_acquire)) return;
+		Cache *nc = new Cache;
+		for (auto &&e : nc->entries) e.store(nullptr, std::memory_order_relaxed);
+		Cache *c = nullptr;
+		//other thread was faster
+		if (!cache.compare_exchange_strong(c, nc, std::memory_order_acq_rel)) delete nc;
+	}
+
+	const IValue *SerializedCache::getSerialized(bool utf8, std::uintptr_t precision) const {
+		Cache *c = cache.load(std::memory_order_acquire);
+		if (c == nullptr) return nullptr;
+		Entry *e = c->entries[utf8 ? 1 : 0].load(std::memory_order_acquire);
+		if (e == nullptr || e->precision != precision) return nullptr;
+		return e->text;
+	}
+
+	void SerializedCache::storeSerialized(bool utf8, std::uintptr_t precision, const PValue &text) const {
+		Cache *c = cache.load(std::memory_order_acquire);
+		if (c == nullptr) return;
+		Entry *ne = new Entry{text, precision};
+		Entry *e = nullptr;
+		if (!c->entries[utf8 ? 1 : 0].compare_exchange_strong(e, ne, std::memory_order_acq_rel)) delete ne;
+	}
+
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include "ivalue.h"
+
+namespace json {
+
+	///Keeps serialized form of an immutable container
+	/** Containers inherit this class. The cache is disabled by default, it is enabled by
+	the function Value::enableSerializedCache(). The first serialization of the container
+	stores the text for the current unicode format, following serializations only copy
+	the text. Containers report enabled cache by the flag serializedCache.
+
+	The text is created with the current maxPrecisionDigits. If the precision is changed
+	later, the container is serialized as usual.
+
+	All functions are thread safe
+	*/
+	class SerializedCache {
+	public:
+		SerializedCache();
+		~SerializedCache();
+
+		///Enables the cache
+		void enableSerializedCache() const;
+		///Returns serializedCache when the cache is enabled, otherwise zero
+		ValueTypeFlags serializedCacheFlags() const {
+			return cache.load(std::memory_order_relaxed) ? serializedCache : 0;
+		}
+		///Retrieves cached text
+		/**
+		@param utf8 true for emitUtf8, false for emitEscaped
+		@param precision current maxPrecisionDigits
+		@return cached text as string value, or nullptr if the text is not available
+		*/
+		const IValue *getSerialized(bool utf8, std::uintptr_t precision) const;
+		///Stores the text to the cache
+		/**
+		@param utf8 true for emitUtf8, false for emitEscaped
+		@param precision maxPrecisionDigits used to create the text
+		@param text serialized container as string value
+		@note the text is not stored, if the cache is disabled or another text is already stored
+		*/
+		void storeSerialized(bool utf8, std::uintptr_t precision, const PValue &text) const;
+
+	protected:
+		struct Entry {
+			PValue text;
+			std::uintptr_t precision;
+		};
+		struct Cache {
+			std::atomic<Entry *> entries[2];
+		};
+
+		mutable std::atomic<Cache *> cache;
+
+		SerializedCache(const SerializedCache &) = delete;
+		SerializedCache &operator=(const SerializedCache &) = delete;
+	};
+
+}
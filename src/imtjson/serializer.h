@@ -1,17 +1,24 @@
 #pragma once
 
+#include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <vector>
 #include "value.h"
+#include "string.h"
+#include "objectValue.h"
+#include "charScan.h"
+#include "doubleConv.h"
+#include "intConv.h"
+#include "rawJsonValue.h"
 
 namespace json {
 
 	///Configures precision of floating numbers
-	/** Global variable specifies count of decimal digits of float numbers. 
-	The default value is 4 for 16bit platform, 8 for 32bit platform and 9 for
-	64bit platform. It can be changed, however, maximum digits is limited
-	to size of uintptr_t type. This limits count of digits max to 10digits on
-	32bit platform and 21 digits on 64bit platform 
+	/** Global variable specifies maximum count of decimal digits after the decimal
+	point of float numbers. The default value is roundTripPrecision, which writes
+	each number as the shortest text, which is parsed back to the same number.
+	Lower values round the numbers (see formatDouble())
 	*/
 	extern uintptr_t maxPrecisionDigits;
 	///Specifies default output format for unicode character during serialization
@@ -20,16 +27,113 @@ namespace json {
 	extern UnicodeFormat defaultUnicodeFormat;
 
 
+	///Output buffer of the serializer
+	/** Collects the serialized text in a contiguous buffer. Unescaped parts of strings,
+	literals and numbers are appended at once. When the buffer reaches the flushSize,
+	its content is passed to the sink. The sink is a function which accepts
+	one argument of type StringView<char>.
+
+	Use the function serializeBuffered() to serialize a value through the buffer
+	*/
+	template<typename Sink>
+	class SerializerBuffer {
+	public:
+		///Default size of the block passed to the sink
+		static const std::size_t defaultFlushSize = 65536;
+
+		SerializerBuffer(const Sink &sink, std::size_t flushSize = defaultFlushSize)
+			:sink(sink), flushSize(flushSize) {}
+
+		void operator()(char c) {
+			buffer.push_back(c);
+			if (buffer.size() >= flushSize) flush();
+		}
+
+		void write(const char *text, std::size_t len) {
+			buffer.insert(buffer.end(), text, text + len);
+			if (buffer.size() >= flushSize) flush();
+		}
+
+		///Passes the buffered text to the sink
+		void flush() {
+			if (!buffer.empty()) {
+				sink(StringView<char>(buffer.data(), buffer.size()));
+				buffer.clear();
+			}
+		}
+
+	protected:
+		Sink sink;
+		std::size_t flushSize;
+		std::vector<char> buffer;
+	};
+
+	///Writes a block of characters to the target of the serializer
+	/** The generic version passes the characters one by one */
+	template<typename Fn>
+	struct SerializerBlockWriter {
+		static void write(Fn &target, const char *text, std::size_t len) {
+			for (std::size_t i = 0; i < len; i++) target(text[i]);
+		}
+	};
+
+	template<typename Sink>
+	struct SerializerBlockWriter<SerializerBuffer<Sink> > {
+		static void write(SerializerBuffer<Sink> &target, const char *text, std::size_t len) {
+			target.write(text, len);
+		}
+	};
+
+	///Serializes the value through the SerializerBuffer
+	/**
+	 * @param v value to serialize
+	 * @param format unicode format
+	 * @param sink function which accepts one argument of type StringView<char>. It receives
+	 * the output in blocks
+	 * @param flushSize size of the block. Use std::size_t(-1) to receive whole output at once
+	 */
+	template<typename Sink>
+	void serializeBuffered(const Value &v, UnicodeFormat format, const Sink &sink,
+			std::size_t flushSize = SerializerBuffer<Sink>::defaultFlushSize);
+
+	///Receives the text of a container, which is stored into SerializedCache
+	/** All serializers use the same type, so the serializer of the cached text
+	is instantiated only once */
+	struct SerializedCacheSink {
+		PValue *text;
+		void operator()(const StringView<char> &data) const {
+			*text = String(data).getHandle();
+		}
+	};
+
+	///Serializes values to the target function
+	/** The containers are walked by an explicit stack (see maxNestingDepth), so the nesting
+	doesn't consume the native stack.
+
+	@note The function serialize(const IValue *) is not virtual. Earlier versions called it
+	recursively for every nested value, so a derived class could override it to change the
+	output of any value. Nested values are now written by the loop of the serializer and
+	the function is called only for the root value, so it is no longer an extension point
+	*/
 	template<typename Fn>
 	class Serializer {
 	public:
 
 
 
-		Serializer(const Fn &target, bool utf8output) :target(target), utf8output(utf8output) {}
+		Serializer(const Fn &target, bool utf8output) :target(target), utf8output(utf8output), baseDepth(0) {}
+		///Creates serializer of a value nested in the containers opened by other serializer
+		/**
+		@param target target function
+		@param utf8output true to emit utf-8, false to escape unicode characters
+		@param baseDepth count of the containers already opened, they count to the maxNestingDepth
+		*/
+		Serializer(const Fn &target, bool utf8output, std::size_t baseDepth)
+			:target(target), utf8output(utf8output), baseDepth(baseDepth) {}
 
 		void serialize(const Value &obj);
-		virtual void serialize(const IValue *ptr);
+		///Serializes the value including all nested values
+		void serialize(const IValue *ptr);
 
 		void serializeObject(const IValue *ptr);
 		void serializeArray(const IValue *ptr);
@@ -40,18 +144,44 @@ namespace json {
 
 		void serializeKeyValue(const IValue *ptr);
 
+		///Retrieves the target of the serializer
+		Fn &getTarget() {return target;}
+
 	protected:
 		Fn target;
 		bool utf8output;
+		///count of the containers opened outside of this serializer
+		std::size_t baseDepth;
 
 		void write(const StringView<char> &text);
+		void writeBlock(const char *text, std::size_t len);
 		void writeUnsigned(std::uintptr_t value);
-		void writeUnsignedRec(std::uintptr_t value);
 		void writeSigned(std::intptr_t value);
 		void writeDouble(double value);
 		void writeUnicode(unsigned int uchar);
 		void writeString(const StringView<char> &text);
-
+		bool writeCached(const IValue *ptr);
+
+		///Open container
+		struct Level {
+			const IValue *container;
+			///the container as CompactObjectValue (keys and values are read directly), or nullptr
+			const CompactObjectValue *compact;
+			bool isObject;
+			///index of the next item
+			std::size_t index;
+			std::size_t count;
+		};
+		///Stack of open containers
+		std::vector<Level> levels;
+
+		///Writes the value, the container is only opened (see serializeLevels())
+		void serializeValue(const IValue *ptr);
+		///Writes the opening bracket and pushes the container to the stack
+		/** @exception SerializerError the nesting is too deep (see maxNestingDepth) */
+		void openContainer(const IValue *ptr, bool isObject);
+		///Writes items of the open containers until the stack returns to the base
+		void serializeLevels(std::size_t base);
 	};
 
 	class SerializerError :public std::runtime_error {
@@ -74,6 +204,14 @@ namespace json {
 		return serializer.serialize(*this);
 	}
 
+	template<typename Sink>
+	inline void serializeBuffered(const Value &v, UnicodeFormat format, const Sink &sink, std::size_t flushSize)
+	{
+		Serializer<SerializerBuffer<Sink> > serializer(SerializerBuffer<Sink>(sink, flushSize), format == emitUtf8);
+		serializer.serialize(v);
+		serializer.getTarget().flush();
+	}
+
 	template<typename Fn>
 	inline void Serializer<Fn>::serialize(const Value & obj)
 	{
@@ -83,17 +221,101 @@ namespace json {
 	template<typename Fn>
 	inline void Serializer<Fn>::serialize(const IValue * ptr)
 	{
+		std::size_t base = levels.size();
+		serializeValue(ptr);
+		serializeLevels(base);
+	}
+
+	template<typename Fn>
+	inline void Serializer<Fn>::serializeValue(const IValue * ptr)
+	{
+		if (ptr->flags() & userDefined) {
+			const RawJsonValue *raw = ptr->unproxy()->getRawJson();
+			if (raw) {
+				write(raw->getJson());
+				return;
+			}
+		}
 		switch (ptr->type()) {
-		case object: serializeObject(ptr); break;
-		case array: serializeArray(ptr); break;
+		case object: if (!writeCached(ptr)) openContainer(ptr, true); break;
+		case array: if (!writeCached(ptr)) openContainer(ptr, false); break;
 		case number: serializeNumber(ptr); break;
 		case string: serializeString(ptr); break;
 		case boolean: serializeBoolean(ptr); break;
 		case null: serializeNull(ptr); break;
 		case undefined: writeString("undefined"); break;
 		}
+	}
 
+	template<typename Fn>
+	inline void Serializer<Fn>::openContainer(const IValue * ptr, bool isObject)
+	{
+		if (baseDepth + levels.size() >= maxNestingDepth)
+			throw SerializerError("Too deep nesting");
+		target(isObject ? '{' : '[');
+		const CompactObjectValue *cobj = isObject ? ptr->unproxy()->asCompactObject() : nullptr;
+		levels.push_back(Level{ptr, cobj, isObject, 0, ptr->size()});
+	}
+
+	template<typename Fn>
+	inline void Serializer<Fn>::serializeLevels(std::size_t base)
+	{
+		try {
+			while (levels.size() > base) {
+				Level &l = levels.back();
+				if (l.index == l.count) {
+					target(l.isObject ? '}' : ']');
+					levels.pop_back();
+					continue;
+				}
+				std::size_t i = l.index++;
+				if (i) target(',');
+				const IValue *item;
+				if (l.compact) {
+					//read keys and values directly, no proxies are needed
+					writeString(l.compact->keyAt(i));
+					target(':');
+					item = l.compact->valueAt(i);
+				} else {
+					item = l.container->itemAtIndex(i);
+					if (l.isObject) {
+						writeString(item->getMemberName());
+						target(':');
+					}
+				}
+				//the reference l is not valid after this call
+				serializeValue(item);
+			}
+		}
+		catch (...) {
+			levels.resize(base);
+			throw;
+		}
+	}
 
+	template<typename Fn>
+	inline bool Serializer<Fn>::writeCached(const IValue * ptr)
+	{
+		if ((ptr->flags() & serializedCache) == 0) return false;
+		const SerializedCache *c = ptr->unproxy()->getSerializedCache();
+		if (c == nullptr) return false;
+		const IValue *text = c->getSerialized(utf8output, maxPrecisionDigits);
+		if (text == nullptr) {
+			//serialize the container into the cache, nested containers can use own caches
+			PValue newText;
+			typedef SerializerBuffer<SerializedCacheSink> Buffer;
+			Serializer<Buffer> serializer(Buffer(SerializedCacheSink{&newText}, std::size_t(-1)), utf8output,
+					baseDepth + levels.size());
+			if (ptr->type() == object) serializer.serializeObject(ptr);
+			else serializer.serializeArray(ptr);
+			serializer.getTarget().flush();
+			c->storeSerialized(utf8output, maxPrecisionDigits, newText);
+			write(newText->getString());
+		}
+		else {
+			write(text->getString());
+		}
+		return true;
 	}
 
 	template<typename Fn>
@@ -108,29 +330,17 @@ namespace json {
 	template<typename Fn>
 	inline void Serializer<Fn>::serializeObject(const IValue * ptr)
 	{
-		target('{');
-		bool comma = false;
-		auto fn = [&](const IValue *v) {
-			if (comma) target(','); else comma = true;
-			serializeKeyValue(v);
-			return true;
-		};
-		ptr->enumItems(EnumFn<decltype(fn)>(fn));
-		target('}');
+		std::size_t base = levels.size();
+		openContainer(ptr, true);
+		serializeLevels(base);
 	}
 
 	template<typename Fn>
 	inline void Serializer<Fn>::serializeArray(const IValue * ptr)
 	{
-		target('[');
-		bool comma = false;
-		auto fn = [&](const IValue *v) {
-			if (comma) target(','); else comma = true;
-			serialize(v);
-			return true;
-		};
-		ptr->enumItems(EnumFn<decltype(fn)>(fn));
-		target(']');
+		std::size_t base = levels.size();
+		openContainer(ptr, false);
+		serializeLevels(base);
 	}
 
 	template<typename Fn>
@@ -164,81 +374,43 @@ namespace json {
 	template<typename Fn>
 	inline void Serializer<Fn>::write(const StringView<char>& text)
 	{
-		for (auto &&x : text) target(x);
+		writeBlock(text.data, text.length);
 	}
 
 	template<typename Fn>
-	inline void Serializer<Fn>::writeUnsignedRec(std::uintptr_t value) {
-		if (value) {
-			writeUnsignedRec(value / 10);
-			target('0' + (value % 10));
-		}
+	inline void Serializer<Fn>::writeBlock(const char *text, std::size_t len)
+	{
+		SerializerBlockWriter<Fn>::write(target, text, len);
 	}
 
 	template<typename Fn>
 	inline void Serializer<Fn>::writeUnsigned(std::uintptr_t value)
 	{
-		if (value) writeUnsignedRec(value);
-		else target('0');
+		char buff[formatIntBufferSize];
+		char *end = formatUnsigned(value, buff);
+		writeBlock(buff, end - buff);
 	}
 
 	template<typename Fn>
 	inline void Serializer<Fn>::writeSigned(std::intptr_t value)
 	{
-		if (value < 0) {
-			target('-');
-			writeUnsigned(-value);
-		}
-		else {
-			writeUnsigned(value);
-		}
+		char buff[formatIntBufferSize];
+		char *end = formatSigned(value, buff);
+		writeBlock(buff, end - buff);
 	}
 
 
 	template<typename Fn>
 	inline void Serializer<Fn>::writeDouble(double value)
 	{
-		//calculate exponent of value
-		//123897 -> 5 (1.23897e5)
-		//0.001248 -> 3 (1.248e-3)
-		double fexp = floor(log10(fabs(value)));
-		//convert it to integer
-		std::intptr_t iexp = (std::intptr_t)fexp;
-		//if exponent is in some reasonable range, set iexp to 0
-		if (iexp > -3 && iexp < 8) {
-			iexp = 0;
+		//JSON has no representation of infinity and NaN
+		if (!std::isfinite(value)) {
+			write("null");
+			return;
 		}
-		else {
-			//otherwise normalize number to be between 1 and 10
-			value = value * pow(0.1, iexp);
-		}		
-		double fint;
-		//separate number to integer and fraction
-		double frac = std::abs(modf(value, &fint));
-		//integer will fit to intptr, so convert it directly
-		writeSigned(std::intptr_t(fint));
-		//if frac is not zero (exactly)
-		if (frac != 0.0) {
-			//put dot
-			target('.');
-
-			double fractMultiply = pow(10, maxPrecisionDigits);
-			//multiply fraction by maximum fit to integer
-			std::uintptr_t m = (std::uintptr_t)floor(frac * fractMultiply +0.5);
-			//remove any rightmost zeroes
-			while (m && (m % 10) == 0) m = m / 10;
-			//write final number
-			writeUnsigned(m);
-		}
-		//if exponent is set
-		if (iexp) {
-			//put E
-			target('e');
-			if (iexp > 0) target('+');
-			//write signed exponent
-			writeSigned(iexp);
-		}
-		//all done
+		char buff[formatDoubleBufferSize];
+		char *end = formatDouble(value, maxPrecisionDigits, buff);
+		writeBlock(buff, end - buff);
 	}
 
 	static inline void notValidUTF8(const std::string &text) {
@@ -284,58 +456,60 @@ namespace json {
 	inline void Serializer<Fn>::writeString(const StringView<char>& text)
 	{
 		target('"');
-		unsigned int uchar = 0;
-		unsigned int extra = 0;
-		for (auto&& c : text) {
-			if ((c & 0x80) == 0x80) {
-				if ((c & 0xC0) == 0x80) {
-					if (extra) {
-						uchar = (uchar << 6) | (c & 0x3F);
-						extra--;
-						if (extra == 0) writeUnicode(uchar);
-					}
-					else {
-						notValidUTF8(text);
-					}
+		const char *p = text.data;
+		const char *end = p + text.length;
+		while (p != end) {
+			//copy the run of characters which don't need escaping at once
+			const char *q = findStringSpecial(p, end);
+			//slash is escaped too, but findStringSpecial() doesn't stop on it
+			const char *s;
+			while ((s = static_cast<const char *>(std::memchr(p, '/', q - p))) != nullptr) {
+				writeBlock(p, s - p);
+				target('\\');
+				target('/');
+				p = s + 1;
+			}
+			writeBlock(p, q - p);
+			p = q;
+			if (p == end) break;
+			unsigned char c = (unsigned char)*p++;
+			if (c & 0x80) {
+				unsigned int uchar = 0;
+				unsigned int extra = 0;
+				if ((c & 0xe0) == 0xc0) {
+					extra = 1;
+					uchar = c & 0x1F;
+				}
+				else if ((c & 0xf0) == 0xe0) {
+					extra = 2;
+					uchar = c & 0x0F;
+				}
+				else if ((c & 0xf8) == 0xf0) {
+					extra = 3;
+					uchar = c & 0x07;
 				}
 				else {
-					if (extra) {
-						notValidUTF8(text);
-					}
-					if ((c & 0xe0) == 0xc0) {
-						extra = 1;
-						uchar = c & 0x1F;
-					}
-					else if ((c & 0xf0) == 0xe0) {
-						extra = 2;
-						uchar = c & 0x0F;
-					}
-					else if ((c & 0xf8) == 0xf0) {
-						extra = 3;
-						uchar = c & 0x07;
-					}
-					else {
-						notValidUTF8(text);
-					}
+					notValidUTF8(text);
 				}
+				for (; extra; extra--) {
+					if (p == end || (*p & 0xC0) != 0x80) notValidUTF8(text);
+					uchar = (uchar << 6) | (*p++ & 0x3F);
+				}
+				writeUnicode(uchar);
 			}
 			else {
 				switch (c) {
 				case '\\':
-				case '/':
-				case '"':target('\\'); target(c); break;
+				case '"':target('\\'); target((char)c); break;
 				case '\f':target('\\'); target('f'); break;
 				case '\b':target('\\'); target('b'); break;
 				case '\r':target('\\'); target('r'); break;
 				case '\n':target('\\'); target('n'); break;
 				case '\t':target('\\'); target('t'); break;
-				default:if (c < 32) writeUnicode(c);else target(c); break;
+				default:writeUnicode(c); break;
 				}
 			}
 		}
-		if (extra) {
-			notValidUTF8(text);
-		}
 		target('"');
 	}
 
@@ -0,0 +1,48 @@
+#include "streamBlocks.h"
+
+namespace json {
+
+	namespace {
+
+		///Accesses the get area of the stream buffer
+		class StreamBufAccess : public std::streambuf {
+		public:
+			static char *begin(std::streambuf *buf) { return (buf->*&StreamBufAccess::gptr)(); }
+			static char *end(std::streambuf *buf) { return (buf->*&StreamBufAccess::egptr)(); }
+			static void consume(std::streambuf *buf, std::size_t count) {
+				(buf->*&StreamBufAccess::gbump)(static_cast<int>(count));
+			}
+		};
+
+	}
+
+	StreamBlocks::StreamBlocks(std::istream &input)
+		:input(&input), buf(input.rdbuf()), single(false), ch(0)
+	{
+	}
+
+	StringView<char> StreamBlocks::operator()(std::size_t used) {
+		release(used);
+		if (buf->sgetc() == std::char_traits<char>::eof()) {
+			input->setstate(std::ios::eofbit);
+			return StringView<char>();
+		}
+		char *b = StreamBufAccess::begin(buf);
+		char *e = StreamBufAccess::end(buf);
+		if (b != e) return StringView<char>(b, e - b);
+		//unbuffered stream provides characters one by one
+		ch = (char)buf->sbumpc();
+		single = true;
+		return StringView<char>(&ch, 1);
+	}
+
+	void StreamBlocks::release(std::size_t used) {
+		if (single) {
+			if (used == 0) buf->sputbackc(ch);
+			single = false;
+		} else if (used) {
+			StreamBufAccess::consume(buf, used);
+		}
+	}
+
+}
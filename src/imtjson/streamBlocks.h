@@ -0,0 +1,47 @@
+#pragma once
+
+#include <istream>
+#include "stringview.h"
+
+namespace json {
+
+	///Provides the buffered characters of std::istream to the parser in blocks
+	/** The object is the function of the BlockSource. The parser reads the characters directly
+	in the buffer of the stream (the get area of the stream buffer) without copying. The stream
+	buffer is advanced only by the characters used by the parser, so the characters after the
+	parsed value stay in the stream.
+
+	Unbuffered streams provide the characters one by one.
+
+	@code
+	StreamBlocks blocks(input);
+	auto fn = [&](std::size_t used) { return blocks(used); };
+	Parser<BlockSource<decltype(fn)> > parser((BlockSource<decltype(fn)>(fn)));
+	Value v = parser.parse();
+	blocks.release(parser.getReader().blockUsed());
+	@endcode
+	*/
+	class StreamBlocks {
+	public:
+		StreamBlocks(std::istream &input);
+
+		///Advances the stream and returns the next block
+		/**
+		@param used count of characters used from the previous block
+		@return next block, empty at the end of the stream (the eofbit is set)
+		*/
+		StringView<char> operator()(std::size_t used);
+
+		///Advances the stream by the characters used from the current block
+		/** The rest of the block stays in the stream. The block can't be used after the call */
+		void release(std::size_t used);
+
+	protected:
+		std::istream *input;
+		std::streambuf *buf;
+		///true if the block is the character ch extracted from an unbuffered stream
+		bool single;
+		char ch;
+	};
+
+}
@@ -23,7 +23,9 @@ String::String():impl(AbstractStringValue::getEmptyString())
 {
 }
 
-String::String(Value v):impl(v.getHandle()) {
+String::String(Value v)
+	//c_str() must be terminated, so the string is copied if it refers an other text
+	:impl((v.flags() & unterminatedString)?Value(v.getString()).getHandle():v.getHandle()) {
 }
 
 String::String(std::size_t sz, std::function<std::size_t(char *)> fillFn):impl(new(sz) StringValue(sz, fillFn)) {
@@ -40,6 +40,26 @@ protected:
 
 };
 
+///String which refers a part of an other string
+/** The other string is kept alive by a reference. The parser uses this class
+ * to refer strings directly in the parsed text (see Value::fromSharedString())
+ *
+ * @note the string is not terminated by zero character, it is reported by the flag
+ * unterminatedString
+ */
+class StringRefValue: public AbstractStringValue {
+public:
+	StringRefValue(const PValue &owner, const StringView<char> &str):owner(owner),str(str) {}
+
+	virtual ValueTypeFlags flags() const override {return unterminatedString;}
+	virtual StringView<char> getString() const override {return str;}
+	virtual bool getBool() const override {return true;}
+
+protected:
+	PValue owner;
+	StringView<char> str;
+};
+
 template<typename Fn>
 inline StringValue::StringValue(std::size_t strSz, const Fn& fn):size(strSz) {
 	charbuff[strSz] = 0;
@@ -54,8 +54,8 @@ namespace json {
 			return 0;
 		}
 
-		bool operator==(const StringView &other) const { return compare(other) == 0; }
-		bool operator!=(const StringView &other) const { return compare(other) != 0; }
+		bool operator==(const StringView &other) const { return length == other.length && compare(other) == 0; }
+		bool operator!=(const StringView &other) const { return !operator==(other); }
 		bool operator>=(const StringView &other) const { return compare(other) >= 0; }
 		bool operator<=(const StringView &other) const { return compare(other) <= 0; }
 		bool operator>(const StringView &other) const { return compare(other) > 0; }
@@ -0,0 +1,98 @@
+#include "tapeParser.h"
+
+namespace json {
+
+	TapeParser::TapeParser(const BufferSource &source)
+		:Parser<BufferSource>(source),source(source)
+	{
+	}
+
+	Value TapeParser::parse() {
+		//offsets are stored as 32bit numbers
+		if (source.length >= 0xFFFFFFFFu) return Parser<BufferSource>::parse();
+		findStructurals(source.data, source.length, structurals);
+		structurals.push_back((std::uint32_t)source.length);
+		levels.clear();
+		try {
+			return parseStructurals();
+		}
+		catch (ParseError &e) {
+			addContext(e, 0);
+			throw;
+		}
+	}
+
+	Value TapeParser::parseStructurals() {
+		const char *end = source.data + source.length;
+		std::size_t i = 0;
+		Value v;
+		for (;;) {
+			//value is expected at the index i
+			//the flag follows is false, when the value is followed by a character, which is not structural
+			bool follows = true;
+			char c = charAt(i);
+			if (c == '{' || c == '[') {
+				char close = c == '{' ? '}' : ']';
+				if (charAt(i + 1) == close) {
+					v = Value(c == '{' ? object : array);
+					rd.seek(structurals[i + 1] + 1);
+					i += 2;
+				} else {
+					pushLevel(c == '{');
+					i = c == '{' ? parseKey(i + 1) : i + 1;
+					continue;
+				}
+			} else {
+				StringView<char> str;
+				rd.seek(structurals[i] + 1);
+				//strings without escape sequences are copied directly from the text
+				if (c == '"' && rd.readPlainString(str)) {
+					v = Value(str);
+				} else {
+					rd.seek(structurals[i]);
+					v = Parser<BufferSource>::parse();
+				}
+				++i;
+				follows = skipWhitespace(source.data + rd.consumed(), end) == source.data + structurals[i];
+			}
+			//value is complete, close containers or continue to the next item
+			for (;;) {
+				if (levels.empty()) return v;
+				tmpArr.push_back(v);
+				bool isObject = levels.back().isObject;
+				c = follows ? charAt(i) : 0;
+				if (c == ',') {
+					i = isObject ? parseKey(i + 1) : i + 1;
+					break;
+				}
+				if (c != (isObject ? '}' : ']')) {
+					throw ParseError(isObject ? "Expected ',' or '}'" : "Expected ',' or ']'");
+				}
+				rd.seek(structurals[i] + 1);
+				++i;
+				v = finishLevel();
+				follows = true;
+			}
+		}
+	}
+
+	std::size_t TapeParser::parseKey(std::size_t i) {
+		if (charAt(i) != '"') throw ParseError("Expected a key (string)");
+		rd.seek(structurals[i] + 1);
+		StringView<char> plain;
+		if (rd.readPlainString(plain)) {
+			tmpKeyOffs.push_back(tmpKeys.length());
+			tmpKeys.append(plain.data, plain.length);
+		} else {
+			std::string name = readString();
+			tmpKeyOffs.push_back(tmpKeys.length());
+			tmpKeys.append(name);
+		}
+		++i;
+		const char *end = source.data + source.length;
+		if (skipWhitespace(source.data + rd.consumed(), end) != source.data + structurals[i] || charAt(i) != ':')
+			throw ParseError("Expected ':'");
+		return i + 1;
+	}
+
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "parser.h"
+
+namespace json {
+
+	///Two-stage parser of contiguous text
+	/** The first stage finds positions of all structural characters of the text at once
+	(see findStructurals()). The second stage walks the positions and creates the values.
+	Whitespaces between the values are not scanned again and containers are tracked by an
+	explicit stack, so the nesting doesn't consume the native stack. Strings and numbers
+	are parsed by the functions of the Parser, so the result is the same as the result
+	of the Parser.
+
+	The parser is used by Value::fromString() and Value::fromBuffer() for the engine
+	parserTape. Texts larger than 4GB are parsed by the Parser.
+
+	@code
+	TapeParser parser(BufferSource(text, length));
+	Value v = parser.parse();
+	@endcode
+	*/
+	class TapeParser : public Parser<BufferSource> {
+	public:
+		TapeParser(const BufferSource &source);
+
+		virtual Value parse() override;
+
+	protected:
+		BufferSource source;
+		///offsets of the structural characters, the last item is the length of the text
+		std::vector<std::uint32_t> structurals;
+
+		///Walks the structural characters and creates the value
+		Value parseStructurals();
+		///Parses the key and the colon
+		/** @param i index of the key
+		@return index of the value */
+		std::size_t parseKey(std::size_t i);
+		///Character at the structural index, -1 at the end of the text
+		char charAt(std::size_t i) const {
+			return i + 1 < structurals.size() ? source.data[structurals[i]] : (char)-1;
+		}
+	};
+
+}
@@ -8,6 +8,14 @@
 #include "serializer.h"
 #include "binary.h"
 #include "stringValue.h"
+#include "string.h"
+#include "parseArena.h"
+#include "chunkOwner.h"
+#include "lazyJsonValue.h"
+#include "tapeParser.h"
+#include "jsonTape.h"
+#include "parseResult.h"
+#include "streamBlocks.h"
 
 namespace json {
 
@@ -35,9 +43,9 @@ namespace json {
 
 	static const IValue *allocString(const StringView<char> &str) {
 		if (str.empty()) return AbstractStringValue::getEmptyString();
-		else {
-			return new(str) StringValue(str);
-		}
+		const IValue *small = AbstractStringValue::getSmallString(str);
+		if (small) return small;
+		return new(str) StringValue(str);
 	}
 
 	Value::Value(const char * value):v(allocString(value))
@@ -59,12 +67,28 @@ namespace json {
 		v = new ArrayValue(std::move(pvs));
 	}
 
+	///Converts number to the text without the serializer
+	static String numberToString(const IValue *v) {
+		char buff[formatDoubleBufferSize > formatIntBufferSize ? formatDoubleBufferSize : formatIntBufferSize];
+		char *end;
+		ValueTypeFlags f = v->flags();
+		if (f & numberUnsignedInteger) end = formatUnsigned(v->getUInt(), buff);
+		else if (f & numberInteger) end = formatSigned(v->getInt(), buff);
+		else {
+			double d = v->getNumber();
+			//same as the serializer
+			if (!std::isfinite(d)) return String("null");
+			end = formatDouble(d, maxPrecisionDigits, buff);
+		}
+		return String(StringView<char>(buff, end - buff));
+	}
+
 	String Value::toString() const
 	{
 		switch (type()) {
 		case null:
-		case boolean:
-		case number: return stringify();
+		case boolean: return stringify();
+		case number: return numberToString(v);
 		case undefined: return String("<undefined>");
 		case object: return stringify();
 		case array: return stringify();
@@ -75,72 +99,225 @@ namespace json {
 
 	Value Value::fromString(const StringView<char>& string)
 	{
-		std::size_t pos = 0;
-		return parse([&pos,&string]() -> char {
-			if (pos == string.length)
-				return -1;
-			else
-				return string.data[pos++];
-		});
+		return fromBuffer(string.data, string.length, defaultParserEngine);
+	}
+
+	Value Value::fromString(const StringView<char>& string, ParserEngine engine)
+	{
+		return fromBuffer(string.data, string.length, engine);
+	}
+
+	ParseResult Value::tryFromString(const StringView<char>& string)
+	{
+		ParseResult res;
+		if (!JsonTape::validate(string, res)) return res;
+		//valid text can still contain a number out of the range
+		Parser<BufferSource> parser((BufferSource(string)));
+		try {
+			return ParseResult(parser.parse());
+		}
+		catch (ParseError &e) {
+			std::size_t offset = parser.getReader().consumed();
+			return ParseResult(e.getMessage(), string, offset, JsonTape::pathAt(string, offset));
+		}
+	}
+
+	Value Value::fromBuffer(const char *data, std::size_t length)
+	{
+		return fromBuffer(data, length, defaultParserEngine);
+	}
+
+	Value Value::fromBuffer(const char *data, std::size_t length, ParserEngine engine)
+	{
+		if (engine == parserTape) {
+			TapeParser parser(BufferSource(data, length));
+			return parser.parse();
+		}
+		return parse(BufferSource(data, length));
+	}
+
+	///Parser which refers plain strings directly in the parsed text
+	class SharedBufferParser : public Parser<BufferSource> {
+	public:
+		SharedBufferParser(const String &text)
+			:Parser<BufferSource>(BufferSource(text.str())), owner(text.getHandle()) {}
+
+		virtual Value parseString() override {
+			StringView<char> str;
+			if (rd.readPlainString(str)) {
+				if (str.empty()) return Value(string);
+				const IValue *small = AbstractStringValue::getSmallString(str);
+				if (small) return Value(small);
+				return Value(new StringRefValue(owner, str));
+			}
+			return Parser<BufferSource>::parseString();
+		}
+
+	protected:
+		PValue owner;
+	};
+
+	Value Value::fromSharedString(const String &text)
+	{
+		SharedBufferParser parser(text);
+		return parser.parse();
+	}
+
+	Value Value::fromStringLazy(const String &text)
+	{
+		return LazyJsonValue::create(text);
+	}
+
+	namespace {
+
+		///Reads a seekable file in blocks
+		/** Blocks grow from a small size, so a small value at the beginning of a large
+		file doesn't cause reading of the whole file. The file position is moved after the
+		parsed value when the parsing is finished */
+		class FileBlocks {
+		public:
+			static const std::size_t minBlock = 4096;
+			static const std::size_t maxBlock = 1024 * 1024;
+
+			FileBlocks(FILE *f, std::vector<char> &buffer) :f(f), buffer(buffer), size(minBlock) {}
+
+			StringView<char> operator()(std::size_t) {
+				if (buffer.size() < size) buffer.resize(size);
+				std::size_t sz = fread(buffer.data(), 1, size, f);
+				if (size < maxBlock) size *= 2;
+				return StringView<char>(buffer.data(), sz);
+			}
+
+		protected:
+			FILE *f;
+			std::vector<char> &buffer;
+			std::size_t size;
+		};
+
+		///Locks the file, so the characters can be read without locking
+		class FileLock {
+		public:
+			FileLock(FILE *f) :f(f) {
+#ifdef _WIN32
+				_lock_file(f);
+#else
+				flockfile(f);
+#endif
+			}
+			~FileLock() {
+#ifdef _WIN32
+				_unlock_file(f);
+#else
+				funlockfile(f);
+#endif
+			}
+			char get() const {
+#ifdef _WIN32
+				return (char)_getc_nolock(f);
+#else
+				return (char)getc_unlocked(f);
+#endif
+			}
+
+		protected:
+			FILE *f;
+		};
+
 	}
 
 	Value Value::fromStream(std::istream & input)
 	{
-		return parse([&]() {
-			return (char)input.get();
-		});
+		StreamBlocks blocks(input);
+		auto fn = [&](std::size_t used) { return blocks(used); };
+		Parser<BlockSource<decltype(fn)> > parser((BlockSource<decltype(fn)>(fn)));
+		try {
+			Value res = parser.parse();
+			blocks.release(parser.getReader().blockUsed());
+			return res;
+		}
+		catch (...) {
+			blocks.release(parser.getReader().blockUsed());
+			throw;
+		}
 	}
 
 	Value Value::fromFile(FILE * f)
 	{
+		//seekable file is read in blocks, unused characters are returned by seeking back
+		long start = ftell(f);
+		if (start >= 0 && fseek(f, start, SEEK_SET) == 0) {
+			std::vector<char> buffer;
+			Parser<BlockSource<FileBlocks> > parser((BlockSource<FileBlocks>(FileBlocks(f, buffer))));
+			try {
+				Value res = parser.parse();
+				fseek(f, start + (long)parser.getReader().consumed(), SEEK_SET);
+				return res;
+			}
+			catch (...) {
+				fseek(f, start + (long)parser.getReader().consumed(), SEEK_SET);
+				throw;
+			}
+		}
+		//other files are read character by character under one lock
+		FileLock lock(f);
 		return parse([&] {
-			return (char)fgetc(f);
+			return lock.get();
 		});
 	}
 
 	String Value::stringify() const
 	{
-		std::string buff;
-		serialize([&](char c) {
-			buff.push_back(c);
-		});
-		return String(buff);
+		return stringify(defaultUnicodeFormat);
 	}
 
 	String Value::stringify(UnicodeFormat format) const
 	{
-		std::string buff;
-		serialize(format,[&](char c) {
-			buff.push_back(c);
-		});
-		return String(buff);
+		String res;
+		//whole output is passed to the sink at once
+		serializeBuffered(*this, format, [&](const StringView<char> &data) {
+			res = String(data);
+		}, std::size_t(-1));
+		return res;
+	}
+
+	Value Value::enableSerializedCache() const
+	{
+		const SerializedCache *c = v->unproxy()->getSerializedCache();
+		if (c) c->enableSerializedCache();
+		return *this;
 	}
 
 	void Value::toStream(std::ostream & output) const
 	{
-		serialize([&](char c) {
-			output.put(c);
-		});
+		toStream(defaultUnicodeFormat, output);
 	}
 
 	void Value::toStream(UnicodeFormat format, std::ostream & output) const
 	{
-		serialize(format, [&](char c) {
-			output.put(c);
+		serializeBuffered(*this, format, [&](const StringView<char> &data) {
+			output.write(data.data, data.length);
 		});
 	}
 
 	template<typename T>
 	PValue allocUnsigned(T x) {
 		if (x == (T)0) return AbstractNumberValue::getZero();
-		if (sizeof(T) <= sizeof(uintptr_t)) return new UnsignedIntegerValue(uintptr_t(x));
+		if (sizeof(T) <= sizeof(uintptr_t)) {
+			const IValue *small = AbstractNumberValue::getSmallUInt(uintptr_t(x));
+			if (small) return small;
+			return new UnsignedIntegerValue(uintptr_t(x));
+		}
 		else return new NumberValue((double)x);
 	}
 
 	template<typename T>
 	PValue allocSigned(T x) {
 		if (x == (T)0) return AbstractNumberValue::getZero();
-		if (sizeof(T) <= sizeof(intptr_t)) return new IntegerValue(intptr_t(x));
+		if (sizeof(T) <= sizeof(intptr_t)) {
+			const IValue *small = AbstractNumberValue::getSmallInt(intptr_t(x));
+			if (small) return small;
+			return new IntegerValue(intptr_t(x));
+		}
 		else return new NumberValue((double)x);
 	}
 
@@ -170,15 +347,13 @@ namespace json {
 
 	void Value::toFile(FILE * f) const
 	{
-		serialize([&](char c) {
-			fputc(c, f);
-		});
+		toFile(defaultUnicodeFormat, f);
 	}
 
 	void Value::toFile(UnicodeFormat format, FILE * f) const
 	{
-		serialize(format, [&](char c) {
-			fputc(c, f);
+		serializeBuffered(*this, format, [&](const StringView<char> &data) {
+			fwrite(data.data, 1, data.length, f);
 		});
 	}
 
@@ -305,10 +480,10 @@ namespace json {
 	{
 	}
 
-	uintptr_t maxPrecisionDigits = sizeof(uintptr_t) < 4 ? 4 : (sizeof(uintptr_t) < 8 ? 9 : 12);
+	uintptr_t maxPrecisionDigits = roundTripPrecision;
 	UnicodeFormat defaultUnicodeFormat = emitEscaped;
-
-	///const double maxMantisaMult = pow(10.0, floor(log10(std::uintptr_t(-1))));
+	ParserEngine defaultParserEngine = parserStreaming;
+	std::size_t maxNestingDepth = 1024;
 
 	bool Value::operator ==(const Value& other) const {
 		if (other.v == v) return true;
@@ -493,9 +668,18 @@ namespace json {
 
 
 
+	static void *defaultAlloc(std::size_t sz) {
+		void *p = ParseArena::allocCurrent(sz);
+		return p ? p : ::operator new(sz);
+	}
+
+	static void defaultDealloc(void *ptr) {
+		if (!ChunkOwner::deallocOwned(ptr)) ::operator delete(ptr);
+	}
+
 	static Allocator defaultAllocator = {
-		&::operator new,
-		&::operator delete
+		&defaultAlloc,
+		&defaultDealloc
 	};
 
 
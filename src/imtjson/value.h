@@ -12,6 +12,7 @@ namespace json {
 	class ValueIterator;
 	class String;
 	class Binary;
+	class ParseResult;
 	template<typename T> class ConvValueAs;
 	template<typename T> class ConvValueFrom;
 
@@ -377,8 +378,84 @@ namespace json {
 		 * @exception ParseError parsing error
 		 */
 		static Value fromString(const StringView<char> &string);
+		///Function parses JSON from string by the specified engine
+		/**
+		 * @param string any string which can be converted to StringView (see the class description)
+		 * @param engine parser engine. The engine parserTape indexes the whole text first, so
+		 * it is intended for texts which contain just the JSON
+		 * @return parsed JSON as value
+		 * @exception ParseError parsing error
+		 */
+		static Value fromString(const StringView<char> &string, ParserEngine engine);
+		///Function parses JSON from string without throwing exceptions
+		/**
+		 * The text is checked by a pass which doesn't throw on invalid text and doesn't
+		 * build any context until it is requested, so rejecting malformed input is cheap.
+		 * Only valid text is parsed. The text must be valid JSON (RFC 8259) with no other
+		 * content than whitespaces around the value, unlike fromString(), which accepts
+		 * some deviations (for example leading '+' of numbers).
+		 *
+		 * @param string any string which can be converted to StringView (see the class description)
+		 * @return the result, which contains either the value or description of the error
+		 * (see ParseResult)
+		 */
+		static ParseResult tryFromString(const StringView<char> &string);
+		///Function parses JSON from a contiguous buffer
+		/**
+		 * The buffer is parsed directly without calling a function for each character.
+		 * This is the fastest way to parse already loaded text.
+		 *
+		 * @param data pointer to the first character
+		 * @param length count of characters in the buffer
+		 * @return parsed JSON as value
+		 * @exception ParseError parsing error
+		 */
+		static Value fromBuffer(const char *data, std::size_t length);
+		///Function parses JSON from a contiguous buffer by the specified engine
+		/**
+		 * @param data pointer to the first character
+		 * @param length count of characters in the buffer
+		 * @param engine parser engine
+		 * @return parsed JSON as value
+		 * @exception ParseError parsing error
+		 */
+		static Value fromBuffer(const char *data, std::size_t length, ParserEngine engine);
+		///Function parses JSON from the String and shares its buffer with the result
+		/**
+		 * Strings without escape sequences are not copied. They refer the text directly
+		 * and keep the whole text alive as long as any of them is referenced. This is useful
+		 * for documents which are parsed and then only inspected.
+		 *
+		 * @param text JSON text. To avoid copying while the text is loaded, construct the
+		 * String through the constructor String(size, fillFn)
+		 * @return parsed JSON as value
+		 * @exception ParseError parsing error
+		 *
+		 * @note Strings which refer the text are not terminated by zero character. Conversion
+		 * to the String (including toString()) copies them, getString() doesn't copy
+		 */
+		static Value fromSharedString(const String &text);
+		///Function indexes JSON in the String and parses only the parts which are accessed
+		/**
+		 * The text is checked and the positions of all objects and arrays are stored in
+		 * an index. Containers are parsed on the first access to their members (operator[],
+		 * size(), enumeration, etc), nested containers are parsed when they are accessed too.
+		 * This is useful for large documents where only few fields are read.
+		 *
+		 * Parts of the document which are serialized are written as they are in the text
+		 *
+		 * @param text JSON text
+		 * @return lazy document
+		 * @exception ParseError the text is not valid JSON
+		 *
+		 * @see LazyJsonValue
+		 */
+		static Value fromStringLazy(const String &text);
 		///Function parses JSON from standard istream
 		/**
+		 * The characters are parsed directly in the buffer of the stream. Characters
+		 * after the parsed value stay in the stream, so the next value can be read
+		 *
 		 * @param input input stream
 		 * @return parsed JSON as value
 		 * @exception ParseError parsing error
@@ -386,6 +463,10 @@ namespace json {
 		static Value fromStream(std::istream &input);
 		///Function parses JSON from C compatible FILE
 		/**
+		 * If the file is seekable, it is read in growing blocks (up to 1MB) and parsed
+		 * from the buffer. The file position is then moved right after the parsed value.
+		 * Other files (pipes, terminals) are parsed character by character
+		 *
 		 * @param f input stream
 		 * @return parsed JSON as value
 		 * @exception ParseError parsing error
@@ -445,6 +526,16 @@ namespace json {
 
 		void toFile(UnicodeFormat format, FILE *f) const;
 
+		///Enables cache of the serialized form of the container
+		/** The first serialization of the container stores the text in the container,
+		 * following serializations only copy the text. This is useful for containers, which
+		 * are serialized repeatedly as a part of other values (for example a shared
+		 * configuration). The text is kept until the container is destroyed.
+		 *
+		 * @return the value itself. Function has no effect on values other than arrays and objects
+		 */
+		Value enableSerializedCache() const;
+
 		///Retrieves a smart pointer (PValue) to underlying object
 		/**
 		 * @return smart pointer to underlying object. Useful only in some special cases.
@@ -760,7 +851,9 @@ public:
 
 		///Pointer to custom allocator
 		/** You can change allocator to achieve better results with allocation 
-		   of values of the JSON. By default, standard new and delete is used.
+		   of values of the JSON. By default, standard new and delete is used,
+		   unless there is a ParseArena installed for the current thread.
+		   See also getPoolAllocator().
 		   This variable is global. By changing it, your allocator must
 		   expect, that some objects are already allocated and will be deallocated
 		   through your deallocator.		   
@@ -13,10 +13,12 @@
 
 #include <memory>
 #include <fstream>
+#include <thread>
 #include "../imtjson/json.h"
 #include "../imtjson/compress.tcc"
 #include "../imtjson/basicValues.h"
 #include "../imtjson/comments.h"
+#include "../imtjson/charScan.h"
 #include "testClass.h"
 
 using namespace json;
@@ -200,6 +202,462 @@ int testMain() {
 		Value v = Value::fromString("{\"a\":1,\"b\":{\"a\":2,\"b\":{\"a\":3,\"b\":{\"a\":4}},\"c\":6},\"a\":7}");
 		out << v.size() << " " << v["b"].size() << " " << v["b"]["b"].size() << " " << v["b"]["b"]["b"].size();
 	};
+	tst.test("Parse.fromBuffer", "abc [1,2,{\"x\":\"a\\\\b\\\"c\"}] 4") >> [](std::ostream &out) {
+		const char text[] = "  \"abc\" [1, 2,{\"x\":\"a\\\\b\\\"c\"}]";
+		out << Value::fromBuffer(text, 7).getString() << " " << Value::fromBuffer(text+8, sizeof(text)-9) << " " << Value::fromBuffer("4", 1);
+	};
+	tst.test("Parse.longStrings", "ok") >> [](std::ostream &out) {
+		//compare buffer parser (scanning in bulk) with character parser at every alignment
+		std::string body;
+		for (int i = 0; i < 100; i++) body.append("0123456789abcdef");
+		const char *specials[] = {"\\\"", "\\n", u8"\u011b", "\\u0041", "\t"};
+		for (std::size_t i = 0; i < 200; i++) {
+			std::string text = "\"" + body + "\"";
+			text.insert(1 + i * 7, specials[i % 5]);
+			text = "  \n\t" + std::string(i % 40, ' ') + "[" + text + "]";
+			std::size_t pos = 0;
+			Value a = Value::fromString(text);
+			Value b = Value::parse([&]() -> char {return pos < text.length() ? text[pos++] : -1;});
+			if (a != b || a[0].getString().length < body.length()) {
+				out << "failed at " << i;
+				return;
+			}
+		}
+		out << "ok";
+	};
+	tst.test("Parse.sharedString", "true,ok,true,false,true,false,x") >> [](std::ostream &out) {
+		Value v;
+		const char *begin, *end;
+		{
+			String text(u8"{\"a\":\"plain text\",\"b\":[\"escaped\\n\",\"utf-8 \u011b\u0161\u010d\",\"\",\"\xC0\x80\"],\"c\":1}");
+			begin = text.str().data;
+			end = begin + text.length();
+			v = Value::fromSharedString(text);
+			out << Value(v == Value::fromString(text)) << ",";
+		}
+		auto inText = [&](const Value &x) {
+			const char *p = x.getString().data;
+			return Value(p >= begin && p < end);
+		};
+		out << (v["a"].getString() == "plain text"?"ok":"failed") << ","
+			<< inText(v["a"]) << "," << inText(v["b"][0]) << "," << inText(v["b"][1]) << ","
+			<< inText(v["b"][2]) << "," << Value::fromSharedString("\"x\"").getString();
+	};
+	tst.test("Parse.sharedString.c_str", "alice,alice,5,alice,true") >> [](std::ostream &out) {
+		String text("{\"name\":\"alice\",\"x\":1}");
+		Value v = Value::fromSharedString(text);
+		String name = v["name"].toString();
+		String name2(v["name"]);
+		out << name.c_str() << "," << name2.c_str() << "," << std::strlen(name.c_str()) << ","
+			<< v["name"].getString() << "," << Value(v["name"].getString().data == text.str().data + 9);
+	};
+	tst.test("Parse.fromFile", "{\"a\":[1,2,3]},true,13") >> [](std::ostream &out) {
+		FILE *f = tmpfile();
+		fputs("{\"a\":[1,2,3]} true 13", f);
+		rewind(f);
+		Value a = Value::fromFile(f);
+		Value b = Value::fromFile(f);
+		Value c = Value::fromFile(f);
+		fclose(f);
+		out << a << "," << b << "," << c;
+	};
+	tst.test("Parse.blocks", "{\"a\":1},20000,true,[1,2],-rest,true,2") >> [](std::ostream &out) {
+		std::string big = "[";
+		for (int i = 0; i < 20000; i++) big.append(i ? ",\"item\"" : "\"item\"");
+		big.append("]");
+		std::istringstream input("{\"a\":1}" + big + " [1,2]-rest");
+		Value a, b, c;
+		input >> a >> b >> c;
+		std::string rest;
+		std::getline(input, rest);
+		out << a << "," << b.size() << "," << Value(b[19999] == "item") << "," << c << "," << rest << ",";
+		FILE *f = tmpfile();
+		fputs(big.c_str(), f);
+		fputs(" 2", f);
+		rewind(f);
+		Value d = Value::fromFile(f);
+		Value e = Value::fromFile(f);
+		fclose(f);
+		out << Value(d == b) << "," << e;
+	};
+	tst.test("ParseArena","{\"a\":[1,2.5,\"text\"],\"b\":{\"c\":null}},[1,2.5,\"text\"],true,true") >> [](std::ostream &out) {
+		Value doc, sub, big;
+		std::string text = "{\"a\":[1,2.5,\"text\"],\"b\":{\"c\":null}}";
+		std::string bigText = "[";
+		for (int i = 0; i < 5000; i++) bigText.append(text).append(",");
+		bigText.append("\"" + std::string(100000, 'x') + "\"]");
+		{
+			ParseArena arena;
+			doc = Value::fromString(text);
+			big = Value::fromString(bigText);
+		}
+		sub = doc["a"];
+		out << doc << ",";
+		doc = Value();
+		out << sub << "," << Value(sub == Value::fromString(text)["a"]) << ","
+			<< Value(big == Value::fromString(bigText));
+	};
+	tst.test("Parse.compactObject", "{\"a\":3,\"b\":{\"x\":[]},\"c\":1} 3 b:{\"x\":[]} a,b,c, true 3 c=1 true") >> [](std::ostream &out) {
+		Value v = Value::fromString("{\"c\":1,\"a\":2,\"b\":{\"x\":[]},\"a\":3}");
+		out << v << " " << v["a"] << " " << v["b"].getKey() << ":" << v["b"] << " ";
+		for (Value x : v) out << x.getKey() << ",";
+		out << " " << Value(v == Value(Object("a", 3)("b", Object("x", json::array))("c", 1)))
+			<< " " << Object::getItems(v).length;
+		StringView<PValue> items = Object::getItems(v);
+		out << " " << Value(items[2]).getKey() << "=" << Value(items[2])
+			<< " " << Value(items.data == Object::getItems(v).data);
+	};
+	tst.test("Parse.sharedKeys", "true,false,true,false,[{\"id\":1,\"name\":\"a\"},{\"id\":2,\"name\":\"b\"},{\"id\":3}]") >> [](std::ostream &out) {
+		Value v = Value::fromString("[{\"id\":1,\"name\":\"a\"},{\"name\":\"b\",\"id\":2},{\"id\":3}]");
+		auto keys = [](Value x) {
+			return (const KeySet *)dynamic_cast<const CompactObjectValue *>(x.getHandle()->unproxy())->getKeySet();
+		};
+		out << Value(keys(v[0]) == keys(v[1])) << "," << Value(keys(v[0]) == keys(v[2])) << ","
+			<< Value(v[0] == Value::fromString("{\"name\":\"a\",\"id\":1}")) << ","
+			<< Value(v[0] == v[1]) << "," << v;
+	};
+	tst.test("Serialize.buffered","ok") >> [](std::ostream &out) {
+		//buffered output must be same as output written by characters
+		Array a;
+		for (int i = 0; i < 200; i++) {
+			a.push_back(Object("text", std::string(i, 'x') + "/\"\\\n\x01\xC3\xA1" + std::to_string(i))
+				("n", i * 12345)("d", i * 0.5)("b", i % 2 == 0)("z", nullptr));
+		}
+		Value v(a);
+		for (UnicodeFormat fmt : {emitEscaped, emitUtf8}) {
+			std::string direct, buffered;
+			v.serialize(fmt, [&](char c) {direct.push_back(c);});
+			//only the last block can be shorter than the flush size
+			bool shortBlock = false, fail = false;
+			serializeBuffered(v, fmt, [&](const StrViewA &data) {
+				fail = fail || shortBlock;
+				shortBlock = data.length < 100;
+				buffered.append(data.data, data.length);
+			}, 100);
+			if (fail || direct != buffered) {out << "fail"; return;}
+			if (v.stringify(fmt) != StrViewA(direct)) {out << "fail stringify"; return;}
+			std::ostringstream s;
+			v.toStream(fmt, s);
+			if (s.str() != direct) {out << "fail stream"; return;}
+		}
+		out << "ok";
+	};
+	tst.test("Serialize.doubleRoundTrip","[0.1,0.30000000000000004,1e+100,-2.5e-7,123456.789,1.7976931348623157e+308,5e-324,null],ok") >> [](std::ostream &out) {
+		uintptr_t prec = maxPrecisionDigits;
+		maxPrecisionDigits = roundTripPrecision;
+		Value v = {0.1, 0.1 + 0.2, 1e100, -2.5e-7, 123456.789, 1.7976931348623157e308, 5e-324, std::numeric_limits<double>::infinity()};
+		out << v.stringify() << ",";
+		//parsed text must produce the same numbers
+		double x = 1.0;
+		bool ok = true;
+		for (int i = 0; i < 1000; i++) {
+			x = x * 1.37 + 1.0 / (i + 3);
+			Value w = Value::fromString(Value(x).stringify());
+			ok = ok && w.getNumber() == x;
+			Value z = Value::fromString(Value(1.0 / x).stringify());
+			ok = ok && z.getNumber() == 1.0 / x;
+		}
+		maxPrecisionDigits = prec;
+		out << (ok ? "ok" : "fail");
+	};
+	tst.test("Serialize.integers","ok") >> [](std::ostream &out) {
+		std::vector<std::intptr_t> nums = {0, 1, 9, 10, 99, 100, 12345, -1, -10, -12345,
+			std::numeric_limits<std::intptr_t>::max(), std::numeric_limits<std::intptr_t>::min()};
+		for (std::intptr_t n : nums) {
+			Value v(n);
+			if (v.stringify() != StrViewA(std::to_string(n)) || v.toString() != StrViewA(std::to_string(n))) {
+				out << "fail " << n;
+				return;
+			}
+		}
+		std::uintptr_t m = std::numeric_limits<std::uintptr_t>::max();
+		if (Value(m).stringify() != StrViewA(std::to_string(m))) out << "fail max";
+		else out << "ok";
+	};
+	tst.test("Serialize.cache","{\"cfg\":{\"a\":[1,2],\"s\":\"\\u00E1\"},\"id\":1},{\"cfg\":{\"a\":[1,2],\"s\":\"\u00e1\"},\"id\":2},true") >> [](std::ostream &out) {
+		//shared configuration is serialized once for each format
+		Value cfg = Value::fromString(u8"{\"s\":\"\u00e1\",\"a\":[1,2]}").enableSerializedCache();
+		Value r1 = Object("id", 1)("cfg", cfg);
+		Value r2 = Object("id", 2)("cfg", cfg);
+		out << r1.stringify(emitEscaped) << "," << r2.stringify(emitUtf8) << ","
+			<< Value((cfg.flags() & serializedCache) != 0 && r1.stringify(emitEscaped) == r1.stringify(emitEscaped));
+	};
+	tst.test("RawJson.c_str","abcdef,6,abcdef") >> [](std::ostream &out) {
+		Value raw = RawJsonValue::create(String("\"abcdef\""));
+		String str(raw);
+		out << str.c_str() << "," << std::strlen(str.c_str()) << "," << raw.toString().c_str();
+	};
+	tst.test("RawJson","{\"id\":1,\"payload\":{ \"b\" : [1,2.50, \"\\u0041\"] }},A,2,true,ok") >> [](std::ostream &out) {
+		//the text is emitted as it is, the content is parsed on demand
+		Value raw = RawJsonValue::create(String("  { \"b\" : [1,2.50, \"\\u0041\"] }\n"));
+		Value env = Object("id", 1)("payload", raw);
+		out << env.stringify() << "," << raw["b"][2].getString() << "," << env["payload"]["b"][1].getUInt() << ",";
+		out << Value(raw == Value::fromString("{\"b\":[1,2.5,\"A\"]}")) << ",";
+		try {
+			RawJsonValue::create(String("{\"a\":[1,}"));
+			out << "fail";
+		} catch (ParseError &) {
+			out << "ok";
+		}
+	};
+	tst.test("Parse.lazy","3,x,true,[true,null],{\"a\\n\":1},{\"k\":[{\"a\\n\":1},2]},true,ok") >> [](std::ostream &out) {
+		//only accessed containers are parsed, untouched parts are written as they are
+		String text("{\"k\":[{\"a\\n\":1},2], \"list\":[1,{\"x\":[true,null]},\"x\"],\"s\":\"\\u0041\"}");
+		Value doc = Value::fromStringLazy(text);
+		Value list = doc["list"];
+		out << list.size() << "," << list[2].getString() << "," << Value(list[1]["x"][0] == Value(true)) << ","
+			<< list[1]["x"].stringify() << "," << doc["k"][0].stringify() << ","
+			<< Value(Object("k", doc["k"])).stringify() << "," << Value(doc == Value::fromString(text)) << ",";
+		try {
+			Value::fromStringLazy(String("{\"a\":[1,2}"));
+			out << "fail";
+		} catch (ParseError &) {
+			out << "ok";
+		}
+	};
+	tst.test("Parse.tape","{\"a\":[1,-2.5,true,null,\"x\\\"\\\\\"],\"b\":{\"c\":{},\"d\":[]}},true,Parse error: 'Expected ',' or ']'' at <root>/b/[1]") >> [](std::ostream &out) {
+		//escaped quotes and backslashes don't confuse the structural index
+		std::string text = "{\"b\":{\"d\":[ ], \"c\":{}}, \"a\" : [1,-2.5,true,null,\"x\\\"\\\\\"]}";
+		Value v = Value::fromString(text, parserTape);
+		out << v.stringify() << "," << Value(v == Value::fromString(text, parserStreaming)) << ",";
+		try {
+			Value::fromString("{\"b\":[1 2]}", parserTape);
+		} catch (ParseError &e) {
+			out << e.what();
+		}
+	};
+#ifndef IMTJSON_NONATOMIC_REFCNT
+	//values are shared between threads
+	tst.test("Parse.parallel","1000,true,3,true,200,true,true,Parse error: 'Expected ',' or ']'' at <root>/[700]/a/[1]") >> [](std::ostream &out) {
+		//small chunks force splitting of the short texts
+		ParallelParser parser(4, 64);
+		std::string arr = "[", nd;
+		for (int i = 0; i < 1000; i++) {
+			std::string item = "{\"id\":" + std::to_string(i) + ",\"s\":\"a,]\\\"[\",\"a\":[" + std::to_string(i) + ",{}]}";
+			arr.append(i ? ",\n" : "").append(item);
+			if (i < 3) nd.append(item).append("\n\n");
+		}
+		arr.append("]");
+		Value a = parser.parseArray(arr);
+		Value n = parser.parseNDJSON(nd);
+		out << a.size() << "," << Value(a == Value::fromString(arr)) << "," << n.size() << "," << Value(n[2] == a[2]) << ",";
+		//values span multiple lines
+		std::string pretty;
+		for (int i = 0; i < 200; i++) pretty.append("{\n  \"i\": " + std::to_string(i) + ",\n  \"s\": \"}\"\n}\n");
+		Value p = parser.parseNDJSON(pretty);
+		out << p.size() << "," << Value(p[199]["i"].getUInt() == 199) << ",";
+		//index built in windows is the same as the index of whole text
+		std::vector<std::uint32_t> whole, part;
+		std::vector<std::size_t> windows;
+		findStructurals(arr.data(), arr.length(), whole);
+		StructuralScanner scanner(arr.data(), arr.length(), 100);
+		while (scanner.next(part)) {
+			for (std::uint32_t pos : part) windows.push_back(scanner.getBase() + pos);
+		}
+		out << Value(std::equal(whole.begin(), whole.end(), windows.begin()) && whole.size() == windows.size()) << ",";
+		arr.replace(arr.find("[700,"), 5, "[700 ");
+		try {
+			parser.parseArray(arr);
+		} catch (ParseError &e) {
+			out << e.what();
+		}
+	};
+#endif
+	tst.test("Stream.ndjson","{\"a\":1}\n[1,2]\n\"x\"\n5\n{}\n,5,[1]| rest") >> [](std::ostream &out) {
+		//NDJSON and concatenated documents are read one by one
+		std::istringstream input("{\"a\":1}\n[1,2]\n\n\"x\" 5{}\n");
+		JsonStreamReader<IStreamSource> reader((IStreamSource(input)));
+		std::string text;
+		auto sink = [&](const StringView<char> &data) {text.append(data.data, data.length);};
+		std::size_t cnt = 0;
+		{
+			JsonStreamWriter<decltype(sink)> writer(sink);
+			Value doc;
+			while (reader.read(doc)) {
+				writer.write(doc);
+				cnt++;
+			}
+		}
+		out << text << "," << cnt << ",";
+		//characters after the document stay in the stream
+		std::istringstream input2("[1] rest");
+		JsonStreamReader<IStreamSource> reader2((IStreamSource(input2)));
+		std::string rest;
+		out << reader2.next();
+		std::getline(input2, rest);
+		out << "|" << rest;
+	};
+	tst.test("Parse.sax","{a:[{s:x,n:-3,u:10,d:2.5,b:true,z:null,e:{}}[]]},9.5") >> [](std::ostream &out) {
+		//events are written in a compact form, numbers are summed
+		struct Handler : SaxHandler {
+			std::ostream &out;
+			double sum;
+			Handler(std::ostream &out) :out(out), sum(0) {}
+			void startObject() {out << "{";}
+			void endObject() {out << "}";}
+			void startArray() {out << "[";}
+			void endArray() {out << "]";}
+			void key(const StringView<char> &k) {out << (k == "a" || k == "s" ? "" : ",") << k << ":";}
+			void string(const StringView<char> &s) {out << s;}
+			void unsignedInteger(std::uintptr_t v) {out << v; sum += v;}
+			void integer(std::intptr_t v) {out << v; sum += v;}
+			void number(double v) {out << v; sum += v;}
+			void boolean(bool v) {out << (v ? "true" : "false");}
+			void null() {out << "null";}
+		};
+		Handler h(out);
+		std::string text = "{\"a\":[{\"s\":\"x\",\"n\":-3,\"u\":10,\"d\":2.5,\"b\":true,\"z\":null,\"e\":{}},[]]}";
+		SaxParser<BufferSource> parser((BufferSource(text)));
+		parser.parseEvents(h);
+		out << "," << h.sum;
+	};
+	tst.test("Parse.push","ok,2,12345,ok,Parse error: 'Unexpected end of file' at <root>") >> [](std::ostream &out) {
+		//the text is split at every possible position, including escape and UTF-8 sequences
+		std::string text = "{\"a\\n\\u0158\":[1,-2,3.25e2,true,false,null,{},[]],\"\xc5\x98x\":{\"b\":\"c\\\"d\"}}";
+		Value expected = Value::fromString(text);
+		bool ok = true;
+		for (std::size_t i = 0; i <= text.length(); i++) {
+			PushParser parser;
+			parser.feed(text.data(), i);
+			parser.feed(text.data() + i, text.length() - i);
+			parser.finish();
+			Value v;
+			ok = ok && parser.read(v) && v == expected && !parser.read(v);
+		}
+		out << (ok ? "ok" : "fail");
+		//stream of values fed byte by byte, the last number is completed by finish()
+		PushParser parser;
+		std::string stream = "[1] \"x\"\n12345";
+		for (char c : stream) parser.feed(&c, 1);
+		out << "," << parser.available();
+		parser.finish();
+		Value v;
+		while (parser.read(v)) {}
+		out << "," << v.toString();
+		parser.reset();
+		parser.feed("{\"a\":[1,2", 9);
+		out << "," << (parser.idle() || parser.available() ? "fail" : "ok");
+		try {
+			parser.finish();
+		} catch (ParseError &e) {
+			out << "," << e.what();
+		}
+	};
+	tst.test("Serialize.chunked","ok,0") >> [](std::ostream &out) {
+		Value doc = Value::fromString("{\"a\":[1,-2,3.5,\"x\\n/y\",true,null,{},[]],\"b\":{\"c\":[[[\"\xc5\x98\"]]]},\"raw\":0}");
+		doc = Object(doc)("raw", RawJsonValue::create("[1, 2]"))("list", Value(array, {1, Object("z", 2), "w"}));
+		std::string expected = doc.stringify().c_str();
+		bool ok = true;
+		for (std::size_t size : {1, 2, 3, 7, 64, 1000}) {
+			ChunkedSerializer ser(doc);
+			std::string res;
+			std::vector<char> buffer(size);
+			std::size_t len;
+			while ((len = ser.read(buffer.data(), size)) == size) res.append(buffer.data(), len);
+			res.append(buffer.data(), len);
+			ok = ok && res == expected && ser.done();
+		}
+		out << (ok ? "ok" : "fail");
+		char c;
+		ChunkedSerializer ser((Value(array)));
+		ser.read(&c, 1);
+		ser.read(&c, 1);
+		out << "," << ser.read(&c, 1);
+	};
+	tst.test("Parse.depthLimit","true,Parse error: 'Too deep nesting' at <root>/[0]/a/[0],true,Too deep nesting,Too deep nesting,Too deep nesting") >> [](std::ostream &out) {
+		//containers are tracked by explicit stacks, the limit is the only constraint
+		std::size_t prevDepth = maxNestingDepth;
+		maxNestingDepth = 20000;
+		std::string text;
+		for (int i = 0; i < 10000; i++) text.append(i & 1 ? "{\"a\":" : "[");
+		text.append("null");
+		for (int i = 9999; i >= 0; i--) text.append(i & 1 ? "}" : "]");
+		Value v = Value::fromString(text);
+		out << Value(v.stringify() == text) << ",";
+		maxNestingDepth = 3;
+		try {
+			Value::fromString("[{\"a\":[[1]]}]");
+		} catch (ParseError &e) {
+			out << e.what() << ",";
+		}
+		out << Value(Value::fromString("[{\"a\":[1]}]", parserTape) == Value::fromString("[{\"a\":[1]}]")) << ",";
+		try {
+			Value(array, {Value(array, {Value(array, {Value(array)})})}).stringify();
+		} catch (SerializerError &e) {
+			out << e.what() << ",";
+		}
+		try {
+			char buffer[64];
+			ChunkedSerializer(Value(array, {Value(array, {Value(array, {Value(array)})})})).read(buffer, sizeof(buffer));
+		} catch (SerializerError &e) {
+			out << e.what() << ",";
+		}
+		try {
+			//cached container is serialized by a nested serializer, which continues the count
+			Value cached = Value(array, {Value(array)}).enableSerializedCache();
+			Value(array, {Value(array, {cached})}).stringify();
+		} catch (SerializerError &e) {
+			out << e.what();
+		}
+		maxNestingDepth = prevDepth;
+	};
+	tst.test("Parse.tryFromString","[1,{\"a\":true}];Expected ',' or ']',22,2,5,<root>/[1]/a\\b/[2];Invalid number,false,1,2,<root>/[0];Too long number,9,1,10,<root>/[1];Invalid string,<root>/a") >> [](std::ostream &out) {
+		ParseResult res = Value::tryFromString(" [1, {\"a\" : true}] ");
+		out << res.getValue() << ";";
+		res = Value::tryFromString("[1,{\"a\\\\b\":[1,2,3\n    5]}]");
+		out << res.getMessage() << "," << res.getOffset() << "," << res.getLine() << "," << res.getColumn() << "," << res.getPath() << ";";
+		res = Value::tryFromString("[+1]");
+		out << res.getMessage() << "," << Value(res.isOk()) << "," << res.getLine() << "," << res.getColumn() << "," << res.getPath() << ";";
+		res = Value::tryFromString("[1, 1e999]");
+		out << res.getMessage() << "," << res.getOffset() << "," << res.getLine() << "," << res.getColumn() << "," << res.getPath() << ";";
+		res = Value::tryFromString("{\"a\":{\"x\":1, \"b");
+		out << res.getMessage() << "," << res.getPath();
+	};
+	tst.test("Object.largeLookup", "ok") >> [](std::ostream &out) {
+		//large objects are searched through the hash index
+		Object o;
+		std::string text = "{";
+		for (int i = 0; i < 1000; i++) {
+			std::string k = "key" + std::to_string(i * 7);
+			o.set(k, i);
+			text.append(i ? "," : "").append("\"" + k + "\":" + std::to_string(i));
+		}
+		text.append("}");
+		Value a(o), b = Value::fromString(text);
+		for (int i = 0; i < 1000; i++) {
+			std::string k = "key" + std::to_string(i * 7);
+			if (a[k].getInt() != i || b[k].getInt() != i || b[k].getKey() != StrViewA(k)) {out << "fail " << k; return;}
+			if (a["x" + k].defined() || b[k + "x"].defined()) {out << "fail x" << k; return;}
+		}
+		out << "ok";
+	};
+	tst.test("Value.smallValues", "true,true,true,false,-128,1023,a,[7,-7,\"x\"]") >> [](std::ostream &out) {
+		Value a = Value::fromString("[7,-7,\"x\"]");
+		out << Value(a[0].getHandle() == Value(7u).getHandle()) << ","
+			<< Value(a[1].getHandle() == Value(-7).getHandle()) << ","
+			<< Value(a[2].getHandle() == Value("x").getHandle()) << ","
+			<< Value(Value(1024).getHandle() == Value(1024).getHandle()) << ","
+			<< Value(-128) << "," << Value(1023u) << "," << Value("a").getString() << "," << a;
+	};
+#ifndef IMTJSON_NONATOMIC_REFCNT
+	//values are shared between threads
+	tst.test("PoolAllocator", "[1,2.5,\"text\"],{\"a\":[1,2.5,\"text\"],\"b\":{\"c\":null}},true") >> [](std::ostream &out) {
+		std::string text = "{\"a\":[1,2.5,\"text\"],\"b\":{\"c\":null}}";
+		const Allocator *prevAllocator = Value::allocator;
+		Value::allocator = getPoolAllocator();
+		Value doc = Value::fromString(text);
+		Value other;
+		Value sub = doc["a"];
+		//values are created and released by other thread
+		std::thread thr([&] {
+			for (int i = 0; i < 1000; i++) other = Value::fromString(text);
+			doc = Value();
+		});
+		thr.join();
+		Value::allocator = prevAllocator;
+		out << sub << "," << other << "," << Value(other == Value::fromString(text));
+	};
+#endif
 	tst.test("Serialize.objects", "{\"a\":7,\"b\":{\"a\":2,\"b\":{\"a\":3,\"b\":{\"a\":4}},\"c\":6}}") >> [](std::ostream &out) {
 		Value v = Value::fromString("{\"a\":1,\"b\":{\"a\":2,\"b\":{\"a\":3,\"b\":{\"a\":4}},\"c\":6},\"a\":7}");
 		v.toStream(out);